@@ -0,0 +1,519 @@
+#include "animation_engine.h"
+#include "trace.h"
+
+#define HACKER_ANIMATION_SPEED_MS 70
+#define HACKER_MAX_ITERATIONS 12
+#define HACKER_MIN_ITERATIONS 6
+#define HACKER_FAST_MAX_ITERATIONS 5
+#define HACKER_FAST_MIN_ITERATIONS 3
+
+#define SLIDE_HALF_DURATION_MS 250
+#define SLIDE_DELAY_STEP_MS 30
+#define SLIDE_MAX_DELAY_STEPS 6
+#define SLIDE_TOTAL_MS (2 * SLIDE_HALF_DURATION_MS + SLIDE_MAX_DELAY_STEPS * SLIDE_DELAY_STEP_MS)
+
+// The compositor redraws running animations at roughly 30 fps
+#define OS_FRAME_INTERVAL_MS 33
+
+#define ANIMATION_ENGINE_MAX_ROWS 12
+
+typedef struct {
+  void (*start)(SlidingRow *row, const char *previous_text, bool fast_mode, bool force_animate);
+  void (*run)(void);
+  uint16_t frame_count;
+  uint32_t duration_ms;
+} AnimationStyleImpl;
+
+static SlidingRow *s_rows[ANIMATION_ENGINE_MAX_ROWS];
+static int s_row_count;
+static AnimationStyle s_style;
+static AnimationEngineIdleHandler s_idle_handler;
+
+#if FEATURE_ANIMATION_HACKER
+// All hacker rows share one Animation; its progress is cut into
+// HACKER_ANIMATION_SPEED_MS frames and each frame steps every animating row
+static Animation *s_frame_animation;
+static uint32_t s_frame_total, s_frames_done;
+#endif
+
+// Every row has settled; animations that were unscheduled instead of finishing
+// are being replaced or torn down and don't count
+static void notify_idle(void) {
+  if (s_idle_handler) s_idle_handler();
+}
+
+// ============================================================================
+// HACKER STYLE
+// ============================================================================
+
+#if FEATURE_ANIMATION_HACKER
+
+// Longest changed stretch the edit-distance alignment handles; anything
+// longer falls back to comparing characters in place
+#define HACKER_ALIGN_MAX 24
+
+// Mark which target characters survive from the previous text: the common
+// prefix and suffix, plus whatever a minimal edit script keeps in between
+static void align_previous(const char *previous, int previous_length,
+                           const char *target, int target_length, bool *kept) {
+  int prefix = 0;
+  while (prefix < previous_length && prefix < target_length && previous[prefix] == target[prefix]) {
+    prefix++;
+  }
+  int suffix = 0;
+  while (suffix < previous_length - prefix && suffix < target_length - prefix &&
+         previous[previous_length - 1 - suffix] == target[target_length - 1 - suffix]) {
+    suffix++;
+  }
+
+  for (int i = 0; i < target_length; i++) {
+    kept[i] = i < prefix || i >= target_length - suffix;
+  }
+
+  const char *a = previous + prefix, *b = target + prefix;
+  int n = previous_length - prefix - suffix, m = target_length - prefix - suffix;
+  if (n == 0 || m == 0) return;
+  if (n > HACKER_ALIGN_MAX || m > HACKER_ALIGN_MAX) {
+    for (int j = 0; j < m && j < n; j++) kept[prefix + j] = (a[j] == b[j]);
+    return;
+  }
+
+  // Levenshtein table; static because the app stack is small
+  static uint8_t cost[HACKER_ALIGN_MAX + 1][HACKER_ALIGN_MAX + 1];
+  for (int i = 0; i <= n; i++) cost[i][0] = i;
+  for (int j = 0; j <= m; j++) cost[0][j] = j;
+  for (int i = 1; i <= n; i++) {
+    for (int j = 1; j <= m; j++) {
+      int best = cost[i - 1][j - 1] + (a[i - 1] != b[j - 1]);
+      if (cost[i - 1][j] + 1 < best) best = cost[i - 1][j] + 1;
+      if (cost[i][j - 1] + 1 < best) best = cost[i][j - 1] + 1;
+      cost[i][j] = best;
+    }
+  }
+
+  // Walk the cheapest script back, keeping the characters it leaves alone
+  int i = n, j = m;
+  while (i > 0 && j > 0) {
+    if (a[i - 1] == b[j - 1] && cost[i][j] == cost[i - 1][j - 1]) {
+      kept[prefix + j - 1] = true;
+      i--;
+      j--;
+    } else if (cost[i][j] == cost[i - 1][j - 1] + 1) {
+      i--;
+      j--;
+    } else if (cost[i][j] == cost[i - 1][j] + 1) {
+      i--;
+    } else {
+      j--;
+    }
+  }
+}
+
+static void hacker_start(SlidingRow *row, const char *previous_text, bool fast_mode, bool force_animate) {
+  HackerRowState *hs = &row->hacker_state;
+  int previous_length = strlen(previous_text);
+  bool has_existing = previous_length > 0 && !force_animate;
+
+  hs->target_length = strlen(hs->target_text);
+  hs->needs_initial_render = true;
+
+  // Without a previous text (or when forced) every character scrambles
+  bool kept[sizeof(hs->target_text)];
+  if (has_existing) {
+    align_previous(previous_text, previous_length, hs->target_text, hs->target_length, kept);
+  } else {
+    memset(kept, 0, sizeof(kept));
+  }
+
+  int first_changed = -1, last_changed = -1, changed = 0;
+  for (int i = 0; i < hs->target_length; i++) {
+    if (kept[i] || hs->target_text[i] == ' ') continue;
+    if (first_changed < 0) first_changed = i;
+    last_changed = i;
+    changed++;
+  }
+  int span = last_changed > first_changed ? last_changed - first_changed : 1;
+
+  // Normalize iteration counts: use same base for all rows to sync animation end times
+  // Fast mode still gets fewer iterations but the range is tighter
+  int min_iter = fast_mode ? HACKER_FAST_MIN_ITERATIONS : HACKER_MIN_ITERATIONS;
+  int max_iter = fast_mode ? HACKER_FAST_MAX_ITERATIONS : HACKER_MAX_ITERATIONS;
+
+  // Iterations ramp across the changed span only, and the ramp shrinks with
+  // the share of the row that changed, so a small edit settles quickly
+  if (hs->target_length > 0) {
+    max_iter = min_iter + (max_iter - min_iter) * changed / hs->target_length;
+  }
+
+  for (int i = 0; i < hs->target_length; i++) {
+    hs->chars[i].target_char = hs->target_text[i];
+
+    if (kept[i] || hs->target_text[i] == ' ') {
+      hs->chars[i].current_char = hs->target_text[i];
+      hs->chars[i].locked = true;
+      hs->chars[i].iterations_left = 0;
+    } else {
+      hs->chars[i].current_char = glyph_atlas_scramble_char(row->atlas, hs->target_text[i]);
+      hs->chars[i].locked = false;
+      float progress = (float)(i - first_changed) / span;
+      int base_iter = min_iter + (int)(progress * (max_iter - min_iter));
+      hs->chars[i].iterations_left = base_iter + (rand() % 2);
+    }
+
+    // Build initial display buffer
+    hs->display_buffer[i] = hs->chars[i].current_char;
+  }
+  hs->display_buffer[hs->target_length] = '\0';
+
+  // Nothing to scramble: show the text and keep the row off the frame timeline
+  hs->animating = first_changed >= 0;
+  if (!hs->animating) {
+    text_layer_set_text(row->label, hs->target_text);
+    return;
+  }
+
+  // Immediately render the initial scrambled state - no waiting for the first frame
+  text_layer_set_text(row->label, hs->display_buffer);
+}
+
+static bool hacker_step(SlidingRow *row) {
+  HackerRowState *hs = &row->hacker_state;
+  if (!hs->animating) return false;
+
+  bool any_unlocked = false;
+  for (int i = 0; i < hs->target_length; i++) {
+    if (hs->chars[i].locked) {
+      hs->display_buffer[i] = hs->chars[i].target_char;
+    } else {
+      any_unlocked = true;
+      if (hs->chars[i].iterations_left <= 0) {
+        hs->chars[i].current_char = hs->chars[i].target_char;
+        hs->chars[i].locked = true;
+        hs->display_buffer[i] = hs->chars[i].target_char;
+      } else {
+        hs->chars[i].iterations_left--;
+        hs->chars[i].current_char = glyph_atlas_scramble_char(row->atlas, hs->chars[i].target_char);
+        hs->display_buffer[i] = hs->chars[i].current_char;
+      }
+    }
+  }
+
+  hs->display_buffer[hs->target_length] = '\0';
+  text_layer_set_text(row->label, hs->display_buffer);
+
+  if (!any_unlocked) {
+    hs->animating = false;
+    text_layer_set_text(row->label, hs->target_text);
+  }
+
+  return any_unlocked;
+}
+
+static void hacker_frame_update(Animation *animation, const AnimationProgress progress) {
+  (void) animation;
+  uint32_t frame = (uint32_t)progress * s_frame_total / ANIMATION_NORMALIZED_MAX;
+  while (s_frames_done < frame) {
+    TRACE(TRACE_EVENT_FRAME_BEGIN, s_frames_done);
+    for (int i = 0; i < s_row_count; i++) {
+      hacker_step(s_rows[i]);
+    }
+    TRACE(TRACE_EVENT_FRAME_END, s_frames_done);
+    s_frames_done++;
+  }
+}
+
+static void hacker_frame_stopped(Animation *animation, bool finished, void *context) {
+  (void) context;
+  if (animation != s_frame_animation) return;
+  s_frame_animation = NULL;
+  if (!finished) return;
+  // Progress is quantized, so make sure nothing is left mid-scramble
+  for (int i = 0; i < s_row_count; i++) {
+    HackerRowState *hs = &s_rows[i]->hacker_state;
+    if (hs->animating) {
+      hs->animating = false;
+      text_layer_set_text(s_rows[i]->label, hs->target_text);
+    }
+  }
+  notify_idle();
+}
+
+static const AnimationImplementation s_hacker_frame_implementation = {
+  .update = hacker_frame_update
+};
+
+static void hacker_run(void) {
+  // The animation lasts exactly as long as the slowest unsettled character
+  uint32_t frames = 0;
+  for (int i = 0; i < s_row_count; i++) {
+    HackerRowState *hs = &s_rows[i]->hacker_state;
+    if (!hs->animating) continue;
+    for (int c = 0; c < hs->target_length; c++) {
+      if (!hs->chars[c].locked && (uint32_t)hs->chars[c].iterations_left + 1 > frames) {
+        frames = hs->chars[c].iterations_left + 1;
+      }
+    }
+  }
+  if (frames == 0) return;
+
+  if (s_frame_animation) animation_unschedule(s_frame_animation);
+  s_frame_animation = NULL;
+
+  s_frame_total = frames;
+  s_frames_done = 0;
+  s_frame_animation = animation_create();
+  animation_set_implementation(s_frame_animation, &s_hacker_frame_implementation);
+  animation_set_duration(s_frame_animation, frames * HACKER_ANIMATION_SPEED_MS);
+  animation_set_curve(s_frame_animation, AnimationCurveLinear);
+  animation_set_handlers(s_frame_animation, (AnimationHandlers) {
+    .stopped = hacker_frame_stopped
+  }, NULL);
+  animation_schedule(s_frame_animation);
+}
+#endif
+
+// ============================================================================
+// SLIDE STYLE
+// ============================================================================
+
+static void set_row_x(SlidingRow *row, int x) {
+  Layer *layer = text_layer_get_layer(row->label);
+  GRect frame = layer_get_frame(layer);
+  frame.origin.x = x;
+  layer_set_frame(layer, frame);
+}
+
+#if FEATURE_ANIMATION_SLIDE
+
+static void slide_start(SlidingRow *row, const char *previous_text, bool fast_mode, bool force_animate) {
+  (void) fast_mode;
+  (void) force_animate;
+  HackerRowState *hs = &row->hacker_state;
+
+  if (row->slide_animation) animation_unschedule(row->slide_animation);
+  row->slide_animation = NULL;
+
+  if (previous_text[0]) {
+    // Keep the old text on screen until the row has left the frame
+    strncpy(hs->display_buffer, previous_text, sizeof(hs->display_buffer) - 1);
+    hs->display_buffer[sizeof(hs->display_buffer) - 1] = '\0';
+    text_layer_set_text(row->label, hs->display_buffer);
+    row->slide_out = true;
+  } else {
+    text_layer_set_text(row->label, hs->target_text);
+    set_row_x(row, row->right_pos);
+    row->slide_out = false;
+  }
+  row->slide_pending = true;
+}
+
+static void slide_out_stopped(Animation *animation, bool finished, void *context) {
+  (void) animation;
+  SlidingRow *row = (SlidingRow *)context;
+  if (finished) text_layer_set_text(row->label, row->hacker_state.target_text);
+}
+
+static void slide_stopped(Animation *animation, bool finished, void *context) {
+  SlidingRow *row = (SlidingRow *)context;
+  if (row->slide_animation == animation) row->slide_animation = NULL;
+  if (!finished) return;
+  // Rows slide with staggered delays, so the last one to land ends the animation
+  for (int i = 0; i < s_row_count; i++) {
+    if (s_rows[i]->slide_animation) return;
+  }
+  notify_idle();
+}
+
+static Animation *create_frame_animation(Layer *layer, GRect from, GRect to, AnimationCurve curve) {
+  PropertyAnimation *property = property_animation_create_layer_frame(layer, &from, &to);
+  Animation *animation = property_animation_get_animation(property);
+  animation_set_duration(animation, SLIDE_HALF_DURATION_MS);
+  animation_set_curve(animation, curve);
+  return animation;
+}
+
+static void slide_run(void) {
+  for (int i = 0; i < s_row_count; i++) {
+    SlidingRow *row = s_rows[i];
+    if (!row->slide_pending) continue;
+    row->slide_pending = false;
+
+    Layer *layer = text_layer_get_layer(row->label);
+    GRect current = layer_get_frame(layer);
+    GRect still = current, left = current, right = current;
+    still.origin.x = row->still_pos;
+    left.origin.x = row->left_pos;
+    right.origin.x = row->right_pos;
+
+    Animation *slide_in = create_frame_animation(layer, right, still, AnimationCurveEaseOut);
+    Animation *slide;
+    if (row->slide_out) {
+      Animation *slide_out = create_frame_animation(layer, current, left, AnimationCurveEaseIn);
+      animation_set_handlers(slide_out, (AnimationHandlers) {
+        .stopped = slide_out_stopped
+      }, row);
+      slide = animation_sequence_create(slide_out, slide_in, NULL);
+    } else {
+      slide = slide_in;
+    }
+
+    animation_set_delay(slide, row->movement_delay * SLIDE_DELAY_STEP_MS);
+    animation_set_handlers(slide, (AnimationHandlers) {
+      .stopped = slide_stopped
+    }, row);
+    row->slide_animation = slide;
+    animation_schedule(slide);
+  }
+}
+#endif
+
+// ============================================================================
+// INSTANT STYLE
+// ============================================================================
+
+static void instant_start(SlidingRow *row, const char *previous_text, bool fast_mode, bool force_animate) {
+  (void) previous_text;
+  (void) fast_mode;
+  (void) force_animate;
+  text_layer_set_text(row->label, row->hacker_state.target_text);
+}
+
+// Styles the build profile leaves out have no start and are never selected
+static const AnimationStyleImpl s_styles[ANIMATION_STYLE_COUNT] = {
+#if FEATURE_ANIMATION_HACKER
+  [ANIMATION_STYLE_HACKER] = {
+    .start = hacker_start, .run = hacker_run,
+    .frame_count = HACKER_MAX_ITERATIONS + 2,
+    .duration_ms = (HACKER_MAX_ITERATIONS + 2) * HACKER_ANIMATION_SPEED_MS
+  },
+#endif
+#if FEATURE_ANIMATION_SLIDE
+  [ANIMATION_STYLE_SLIDE] = {
+    .start = slide_start, .run = slide_run,
+    .frame_count = SLIDE_TOTAL_MS / OS_FRAME_INTERVAL_MS,
+    .duration_ms = SLIDE_TOTAL_MS
+  },
+#endif
+  [ANIMATION_STYLE_INSTANT] = {
+    .start = instant_start, .run = NULL,
+    .frame_count = 1,
+    .duration_ms = 0
+  },
+};
+
+// ============================================================================
+// ENGINE
+// ============================================================================
+
+// Stop whatever a row is doing and show its final text in place
+static void settle_row(SlidingRow *row) {
+  if (row->slide_animation) animation_unschedule(row->slide_animation);
+  row->slide_animation = NULL;
+  row->slide_pending = false;
+  row->hacker_state.animating = false;
+  text_layer_set_text(row->label, row->hacker_state.target_text);
+  set_row_x(row, row->still_pos);
+}
+
+static bool style_available(AnimationStyle style) {
+  return style >= 0 && style < ANIMATION_STYLE_COUNT && s_styles[style].start;
+}
+
+static void settle_all(void) {
+#if FEATURE_ANIMATION_HACKER
+  if (s_frame_animation) animation_unschedule(s_frame_animation);
+  s_frame_animation = NULL;
+#endif
+  for (int i = 0; i < s_row_count; i++) {
+    settle_row(s_rows[i]);
+  }
+}
+
+void animation_engine_init(AnimationStyle style) {
+  s_style = style_available(style) ? style : ANIMATION_STYLE_DEFAULT;
+  s_row_count = 0;
+#if FEATURE_ANIMATION_HACKER
+  s_frame_animation = NULL;
+#endif
+}
+
+void animation_engine_deinit(void) {
+  s_idle_handler = NULL;
+#if FEATURE_ANIMATION_HACKER
+  if (s_frame_animation) animation_unschedule(s_frame_animation);
+  s_frame_animation = NULL;
+#endif
+  for (int i = 0; i < s_row_count; i++) {
+    if (s_rows[i]->slide_animation) animation_unschedule(s_rows[i]->slide_animation);
+  }
+  s_row_count = 0;
+}
+
+void animation_engine_register_row(SlidingRow *row) {
+  if (s_row_count >= ANIMATION_ENGINE_MAX_ROWS) return;
+  row->slide_animation = NULL;
+  row->slide_pending = false;
+  row->slide_out = false;
+  s_rows[s_row_count++] = row;
+}
+
+void animation_engine_unregister_row(SlidingRow *row) {
+  for (int i = 0; i < s_row_count; i++) {
+    if (s_rows[i] != row) continue;
+    if (row->slide_animation) animation_unschedule(row->slide_animation);
+    row->slide_animation = NULL;
+    s_rows[i] = s_rows[--s_row_count];
+    return;
+  }
+}
+
+void animation_engine_set_style(AnimationStyle style) {
+  if (!style_available(style) || style == s_style) return;
+  settle_all();
+  s_style = style;
+}
+
+AnimationStyle animation_engine_get_style(void) {
+  return s_style;
+}
+
+void animation_engine_set_idle_handler(AnimationEngineIdleHandler handler) {
+  s_idle_handler = handler;
+}
+
+void animation_engine_animate_text(SlidingRow *row, const char *text, bool fast_mode, bool force_animate) {
+  HackerRowState *hs = &row->hacker_state;
+
+  // The label may be showing target_text itself, so snapshot it before overwriting
+  char previous_text[sizeof(hs->target_text)];
+  const char *current_text = text_layer_get_text(row->label);
+  strncpy(previous_text, current_text ? current_text : "", sizeof(previous_text) - 1);
+  previous_text[sizeof(previous_text) - 1] = '\0';
+
+  if (text != hs->target_text) {
+    strncpy(hs->target_text, text, sizeof(hs->target_text) - 1);
+    hs->target_text[sizeof(hs->target_text) - 1] = '\0';
+  }
+  s_styles[s_style].start(row, previous_text, fast_mode, force_animate);
+}
+
+void animation_engine_show_text(SlidingRow *row, const char *text) {
+  HackerRowState *hs = &row->hacker_state;
+  if (text != hs->target_text) {
+    strncpy(hs->target_text, text, sizeof(hs->target_text) - 1);
+    hs->target_text[sizeof(hs->target_text) - 1] = '\0';
+  }
+  settle_row(row);
+}
+
+void animation_engine_run(void) {
+  if (s_styles[s_style].run) s_styles[s_style].run();
+}
+
+uint16_t animation_engine_style_frame_count(AnimationStyle style) {
+  return (style >= 0 && style < ANIMATION_STYLE_COUNT) ? s_styles[style].frame_count : 0;
+}
+
+uint32_t animation_engine_style_duration_ms(AnimationStyle style) {
+  return (style >= 0 && style < ANIMATION_STYLE_COUNT) ? s_styles[style].duration_ms : 0;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <pebble.h>
+#include "sliding_row.h"
+
+// Values are what the config page sends and what is persisted, keep them stable
+typedef enum {
+  ANIMATION_STYLE_HACKER = 0,
+  ANIMATION_STYLE_SLIDE = 1,
+  ANIMATION_STYLE_INSTANT = 2,
+  ANIMATION_STYLE_COUNT
+} AnimationStyle;
+
+// The richest style the build profile compiles in
+#if FEATURE_ANIMATION_HACKER
+#define ANIMATION_STYLE_DEFAULT ANIMATION_STYLE_HACKER
+#elif FEATURE_ANIMATION_SLIDE
+#define ANIMATION_STYLE_DEFAULT ANIMATION_STYLE_SLIDE
+#else
+#define ANIMATION_STYLE_DEFAULT ANIMATION_STYLE_INSTANT
+#endif
+
+void animation_engine_init(AnimationStyle style);
+void animation_engine_deinit(void);
+void animation_engine_register_row(SlidingRow *row);
+// Stop tracking a row before its layer is destroyed
+void animation_engine_unregister_row(SlidingRow *row);
+
+void animation_engine_set_style(AnimationStyle style);
+AnimationStyle animation_engine_get_style(void);
+
+// Called when the animations started by animation_engine_run() have all run to
+// their end; the instant style never animates and so never calls it
+typedef void (*AnimationEngineIdleHandler)(void);
+void animation_engine_set_idle_handler(AnimationEngineIdleHandler handler);
+
+// Prepare a row for its new text; nothing moves until animation_engine_run()
+void animation_engine_animate_text(SlidingRow *row, const char *text, bool fast_mode, bool force_animate);
+// Put text on a row immediately, bypassing the active style
+void animation_engine_show_text(SlidingRow *row, const char *text);
+// Schedule every prepared row on the OS animation timeline
+void animation_engine_run(void);
+
+// Cost of a full row change in each style, for choosing per platform
+uint16_t animation_engine_style_frame_count(AnimationStyle style);
+uint32_t animation_engine_style_duration_ms(AnimationStyle style);
@@ -0,0 +1,70 @@
+#include "battery_history.h"
+#include "trace.h"
+
+// Persist key for the BatteryHistory blob, next to the app's own keys
+#define PERSIST_BATTERY_HISTORY 109
+#define BATTERY_HISTORY_VERSION 1
+
+// Drops closer together than this are the reading settling, not the battery draining
+#define MIN_SLOPE_INTERVAL_S 60
+// Each new slope moves the rate a quarter of the way, so one odd stretch
+// (a long vibration, a backlight left on) can't swing the estimate
+#define RATE_SMOOTHING 4
+
+static BatteryHistory s_history;
+
+void battery_history_init(void) {
+  if (persist_get_size(PERSIST_BATTERY_HISTORY) == (int)sizeof(s_history)) {
+    persist_read_data(PERSIST_BATTERY_HISTORY, &s_history, sizeof(s_history));
+  }
+  if (s_history.version != BATTERY_HISTORY_VERSION) {
+    memset(&s_history, 0, sizeof(s_history));
+    s_history.version = BATTERY_HISTORY_VERSION;
+  }
+}
+
+static const BatterySample *latest(void) {
+  if (s_history.count == 0) return NULL;
+  return &s_history.samples[(s_history.head + BATTERY_HISTORY_SIZE - 1) % BATTERY_HISTORY_SIZE];
+}
+
+// Only a drop between two discharging readings says how fast the battery goes;
+// a rise means it was charged in between, even if no event said so
+static void update_rate(const BatterySample *previous, const BatterySample *sample) {
+  if (previous->charging || sample->charging || sample->percent >= previous->percent) return;
+  int32_t elapsed = (int32_t)(sample->timestamp - previous->timestamp);
+  if (elapsed < MIN_SLOPE_INTERVAL_S) return;
+
+  int32_t slope = (int32_t)((previous->percent - sample->percent) * 1000LL * 3600 / elapsed);
+  if (s_history.rate == 0) s_history.rate = slope;
+  else s_history.rate += (slope - s_history.rate) / RATE_SMOOTHING;
+}
+
+void battery_history_record(BatteryChargeState state, time_t now) {
+  BatterySample sample = {
+    .timestamp = (uint32_t)now,
+    .percent = state.charge_percent,
+    .charging = state.is_charging || state.is_plugged,
+  };
+  const BatterySample *previous = latest();
+  if (previous && previous->percent == sample.percent && previous->charging == sample.charging) return;
+  if (previous) update_rate(previous, &sample);
+
+  s_history.samples[s_history.head] = sample;
+  s_history.head = (s_history.head + 1) % BATTERY_HISTORY_SIZE;
+  if (s_history.count < BATTERY_HISTORY_SIZE) s_history.count++;
+  TRACE(TRACE_EVENT_PERSIST_WRITE, PERSIST_BATTERY_HISTORY);
+  persist_write_data(PERSIST_BATTERY_HISTORY, &s_history, sizeof(s_history));
+}
+
+int32_t battery_history_rate(void) {
+  return s_history.rate;
+}
+
+int32_t battery_history_minutes_left(time_t now) {
+  const BatterySample *sample = latest();
+  if (!sample || sample->charging || s_history.rate <= 0) return -1;
+  int32_t minutes = (int32_t)(sample->percent * 60000LL / s_history.rate);
+  minutes -= (int32_t)(now - (time_t)sample->timestamp) / 60;
+  return minutes > 0 ? minutes : 0;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <pebble.h>
+
+// Recent battery readings, persisted, and the discharge rate fitted to them.
+// Fed only from battery_state_service events: nothing here polls the battery
+#define BATTERY_HISTORY_SIZE 12
+
+typedef struct __attribute__((packed)) {
+  uint32_t timestamp;
+  uint8_t percent;
+  uint8_t charging;
+} BatterySample;
+
+typedef struct __attribute__((packed)) {
+  uint8_t version;
+  uint8_t count, head;      // ring of the latest changes, head is the next to write
+  int32_t rate;             // discharge in thousandths of a percent per hour, 0 until measured
+  BatterySample samples[BATTERY_HISTORY_SIZE];
+} BatteryHistory;
+
+// Load the persisted ring and rate
+void battery_history_init(void);
+// Record a battery_state_service reading; unchanged readings are dropped
+void battery_history_record(BatteryChargeState state, time_t now);
+// Thousandths of a percent per hour while discharging, 0 until measured
+int32_t battery_history_rate(void);
+// Minutes until empty at the measured rate, counted from the latest reading;
+// -1 while charging or before a rate was measured
+int32_t battery_history_minutes_left(time_t now);
@@ -0,0 +1,111 @@
+#include "complications.h"
+#include "trace.h"
+
+// Persist key for the Layout blob; 100-105 and 107-111 belong to the app, sun_times.c,
+// battery_history.c and the worker
+#define PERSIST_LAYOUT 106
+// Before layouts, a toggle swapped the step count for sunrise/sunset on the bottom line
+#define PERSIST_LEGACY_SHOW_SUN_TIMES 104
+
+static const uint8_t s_default_slots[COMPLICATION_COUNT] = {
+  [COMPLICATION_WEATHER] = SLOT_TOP_LEFT,
+  [COMPLICATION_CONDITION] = SLOT_SECOND_LEFT,
+#if FEATURE_HEALTH
+  [COMPLICATION_STEPS] = SLOT_BOTTOM_LEFT,
+#else
+  [COMPLICATION_STEPS] = SLOT_OFF,
+#endif
+  [COMPLICATION_BATTERY] = SLOT_BOTTOM_RIGHT,
+  [COMPLICATION_DAY] = SLOT_TOP_RIGHT,
+  [COMPLICATION_DATE] = SLOT_SECOND_RIGHT,
+  [COMPLICATION_SUN] = SLOT_OFF,
+  [COMPLICATION_HEART_RATE] = SLOT_OFF,
+};
+
+static const int16_t s_line_y[LAYOUT_LINE_COUNT] = { -2, 14, 144 };
+
+// MESSAGE_KEY_* are link-time values, so they can't sit in a static table
+static uint32_t message_key(Complication complication) {
+  switch (complication) {
+    case COMPLICATION_WEATHER: return MESSAGE_KEY_WeatherSlot;
+    case COMPLICATION_CONDITION: return MESSAGE_KEY_ConditionSlot;
+    case COMPLICATION_STEPS: return MESSAGE_KEY_StepsSlot;
+    case COMPLICATION_BATTERY: return MESSAGE_KEY_BatterySlot;
+    case COMPLICATION_DAY: return MESSAGE_KEY_DaySlot;
+    case COMPLICATION_DATE: return MESSAGE_KEY_DateSlot;
+    case COMPLICATION_SUN: return MESSAGE_KEY_SunSlot;
+    case COMPLICATION_HEART_RATE: return MESSAGE_KEY_HeartRateSlot;
+    default: return 0;
+  }
+}
+
+static void sanitize(Layout *layout) {
+  for (int i = 0; i < COMPLICATION_COUNT; i++) {
+    if (layout->slots[i] >= SLOT_COUNT) layout->slots[i] = SLOT_OFF;
+  }
+  // Nothing to count steps with, or no phone data in this build
+  if (!FEATURE_HEALTH) layout->slots[COMPLICATION_STEPS] = SLOT_OFF;
+  if (!FEATURE_HEART_RATE) layout->slots[COMPLICATION_HEART_RATE] = SLOT_OFF;
+  if (!FEATURE_WEATHER) {
+    layout->slots[COMPLICATION_WEATHER] = SLOT_OFF;
+    layout->slots[COMPLICATION_CONDITION] = SLOT_OFF;
+    layout->slots[COMPLICATION_SUN] = SLOT_OFF;
+  }
+}
+
+void layout_load(Layout *layout) {
+  memcpy(layout->slots, s_default_slots, sizeof(layout->slots));
+  int size = persist_get_size(PERSIST_LAYOUT);
+  if (size > 0 && size <= (int)sizeof(*layout)) {
+    // Complications are only ever appended, so an older layout is a prefix
+    // and the ones added since keep their defaults
+    persist_read_data(PERSIST_LAYOUT, layout, size);
+  } else if (persist_read_bool(PERSIST_LEGACY_SHOW_SUN_TIMES)) {
+    layout->slots[COMPLICATION_SUN] = SLOT_BOTTOM_LEFT;
+    layout->slots[COMPLICATION_STEPS] = SLOT_OFF;
+  }
+  sanitize(layout);
+}
+
+void layout_save(const Layout *layout) {
+  TRACE(TRACE_EVENT_PERSIST_WRITE, PERSIST_LAYOUT);
+  persist_write_data(PERSIST_LAYOUT, layout, sizeof(*layout));
+  if (persist_exists(PERSIST_LEGACY_SHOW_SUN_TIMES)) persist_delete(PERSIST_LEGACY_SHOW_SUN_TIMES);
+}
+
+bool layout_update_from_message(Layout *layout, DictionaryIterator *iterator) {
+  bool changed = false;
+  for (int i = 0; i < COMPLICATION_COUNT; i++) {
+    Tuple *tuple = dict_find(iterator, message_key((Complication)i));
+    if (!tuple) continue;
+    // Clay sends select values as strings
+    int slot = tuple->type == TUPLE_CSTRING ? atoi(tuple->value->cstring) : (int)tuple->value->int32;
+    if (slot < 0 || slot >= SLOT_COUNT) slot = SLOT_OFF;
+    if (layout->slots[i] != slot) {
+      layout->slots[i] = (uint8_t)slot;
+      changed = true;
+    }
+  }
+  sanitize(layout);
+  return changed;
+}
+
+Complication layout_complication_at(const Layout *layout, Slot slot) {
+  if (slot == SLOT_OFF) return COMPLICATION_COUNT;
+  for (int i = 0; i < COMPLICATION_COUNT; i++) {
+    if (layout->slots[i] == slot) return (Complication)i;
+  }
+  return COMPLICATION_COUNT;
+}
+
+Slot layout_slot_of(const Layout *layout, Complication complication) {
+  Slot slot = (Slot)layout->slots[complication];
+  return layout_complication_at(layout, slot) == complication ? slot : SLOT_OFF;
+}
+
+GRect layout_slot_frame(Slot slot, int16_t width, bool wide) {
+  const int16_t padding = 5;
+  int16_t y = s_line_y[SLOT_LINE(slot)];
+  if (SLOT_IS_RIGHT(slot) || wide) return GRect(2, y, width - padding, 60);
+  return GRect(2, y, (width * 3) / 4, 60);
+}
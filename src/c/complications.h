@@ -0,0 +1,54 @@
+#pragma once
+
+#include <pebble.h>
+#include "feature_profile.h"
+
+// Values index the persisted layout, keep them stable
+typedef enum {
+  COMPLICATION_WEATHER = 0,    // temperature
+  COMPLICATION_CONDITION = 1,
+  COMPLICATION_STEPS = 2,
+  COMPLICATION_BATTERY = 3,
+  COMPLICATION_DAY = 4,
+  COMPLICATION_DATE = 5,
+  COMPLICATION_SUN = 6,
+  COMPLICATION_HEART_RATE = 7,
+  COMPLICATION_COUNT
+} Complication;
+
+// Values are what the config page sends and what is persisted
+typedef enum {
+  SLOT_OFF = 0,
+  SLOT_TOP_LEFT = 1,
+  SLOT_TOP_RIGHT = 2,
+  SLOT_SECOND_LEFT = 3,
+  SLOT_SECOND_RIGHT = 4,
+  SLOT_BOTTOM_LEFT = 5,
+  SLOT_BOTTOM_RIGHT = 6,
+  SLOT_COUNT
+} Slot;
+
+// Each line holds a left and a right slot
+#define LAYOUT_LINE_COUNT 3
+#define SLOT_LEFT(line) ((Slot)((line) * 2 + 1))
+#define SLOT_RIGHT(line) ((Slot)((line) * 2 + 2))
+#define SLOT_LINE(slot) (((slot) - 1) / 2)
+#define SLOT_IS_RIGHT(slot) ((slot) != SLOT_OFF && (slot) % 2 == 0)
+
+typedef struct {
+  uint8_t slots[COMPLICATION_COUNT];
+} Layout;
+
+// Persisted layout, or the classic one when nothing was saved yet
+void layout_load(Layout *layout);
+void layout_save(const Layout *layout);
+// Apply the slot selects from a settings message; true if anything moved
+bool layout_update_from_message(Layout *layout, DictionaryIterator *iterator);
+
+// The first complication placed in a slot wins it; COMPLICATION_COUNT when empty
+Complication layout_complication_at(const Layout *layout, Slot slot);
+// Where a complication shows, or SLOT_OFF when it's off or lost its slot
+Slot layout_slot_of(const Layout *layout, Complication complication);
+
+// Left slots may span most of the line when `wide`, right slots are right-aligned
+GRect layout_slot_frame(Slot slot, int16_t width, bool wide);
@@ -0,0 +1,70 @@
+#pragma once
+
+// Build profiles; wscript passes FEATURE_PROFILE per platform and any
+// FEATURE_* below can still be overridden on its own with -D
+#define FEATURE_PROFILE_MINIMAL 0    // aplite: no hacker scramble, health or trace, small buffers
+#define FEATURE_PROFILE_STANDARD 1   // everything users see
+#define FEATURE_PROFILE_FULL 2       // plus the trace instrumentation
+
+#ifndef FEATURE_PROFILE
+#define FEATURE_PROFILE FEATURE_PROFILE_FULL
+#endif
+
+// Animation styles; instant is always available
+#ifndef FEATURE_ANIMATION_HACKER
+#define FEATURE_ANIMATION_HACKER (FEATURE_PROFILE >= FEATURE_PROFILE_STANDARD)
+#endif
+#ifndef FEATURE_ANIMATION_SLIDE
+#define FEATURE_ANIMATION_SLIDE 1
+#endif
+
+// Step count (and the worker's step tracking), only where the watch has health
+#ifndef FEATURE_HEALTH
+#if defined(PBL_HEALTH)
+#define FEATURE_HEALTH (FEATURE_PROFILE >= FEATURE_PROFILE_STANDARD)
+#else
+#define FEATURE_HEALTH 0
+#endif
+#endif
+
+// Heart rate row on the platforms whose watches can have an HRM; a diorite
+// without one is caught at runtime
+#ifndef FEATURE_HEART_RATE
+#if defined(PBL_PLATFORM_DIORITE) || defined(PBL_PLATFORM_EMERY)
+#define FEATURE_HEART_RATE FEATURE_HEALTH
+#else
+#define FEATURE_HEART_RATE 0
+#endif
+#endif
+
+// Temperature, condition and sunrise/sunset, which needs the phone's location
+#ifndef FEATURE_WEATHER
+#define FEATURE_WEATHER 1
+#endif
+
+// Condition icons from vector resources; aplite has no draw commands, and no RAM to spare
+#ifndef FEATURE_WEATHER_ICONS
+#if defined(PBL_PLATFORM_APLITE)
+#define FEATURE_WEATHER_ICONS 0
+#else
+#define FEATURE_WEATHER_ICONS FEATURE_WEATHER
+#endif
+#endif
+
+// Seconds in words for a few seconds after a wrist flick, when turned on in settings
+#ifndef FEATURE_FLICK_SECONDS
+#define FEATURE_FLICK_SECONDS (FEATURE_PROFILE >= FEATURE_PROFILE_STANDARD)
+#endif
+
+#ifndef FEATURE_TRACE
+#define FEATURE_TRACE (FEATURE_PROFILE >= FEATURE_PROFILE_FULL)
+#endif
+
+// Longest text a row holds, terminator included; sizes every per-row buffer
+#ifndef ROW_TEXT_MAX
+#define ROW_TEXT_MAX (FEATURE_PROFILE >= FEATURE_PROFILE_STANDARD ? 64 : 32)
+#endif
+
+// Weather and settings messages fit in 128 bytes; only trace chunks need a big outbox
+#define APP_MESSAGE_INBOX_SIZE (FEATURE_PROFILE >= FEATURE_PROFILE_STANDARD ? 256 : 128)
+#define APP_MESSAGE_OUTBOX_SIZE (FEATURE_TRACE ? 256 : 64)
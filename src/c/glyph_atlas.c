@@ -0,0 +1,116 @@
+#include "glyph_atlas.h"
+
+// One atlas per distinct font in use (bitham42 bold/light, gothic18 bold/regular)
+#define GLYPH_ATLAS_MAX_FONTS 4
+
+static GlyphAtlas s_atlases[GLYPH_ATLAS_MAX_FONTS];
+
+static const char s_charset[] = GLYPH_ATLAS_CHARSET;
+
+static int charset_index(char c) {
+  if (c >= 'a' && c <= 'z') return c - 'a';
+  if (c >= '0' && c <= '9') return 26 + (c - '0');
+  return -1;
+}
+
+static int glyph_index(char c) {
+  int idx = c - GLYPH_ATLAS_FIRST_GLYPH;
+  return (idx >= 0 && idx < GLYPH_ATLAS_GLYPH_COUNT) ? idx : -1;
+}
+
+static int layout_width(GFont font, const char *text) {
+  GSize size = graphics_text_layout_get_content_size(text, font, GRect(0, 0, 200, 100),
+                                                     GTextOverflowModeWordWrap, GTextAlignmentLeft);
+  return size.w;
+}
+
+static uint8_t measure_glyph(GFont font, char c) {
+  // A lone space lays out to nothing, so take it as the difference it makes between two glyphs
+  if (c == ' ') {
+    int width = layout_width(font, "x x") - layout_width(font, "xx");
+    return width > 0 ? (uint8_t)width : 0;
+  }
+  char text[2] = { c, '\0' };
+  return (uint8_t)layout_width(font, text);
+}
+
+static uint8_t charset_advance(const GlyphAtlas *atlas, char c) {
+  return atlas->advance[glyph_index(c)];
+}
+
+static void build_atlas(GlyphAtlas *atlas, GFont font) {
+  atlas->font = font;
+  memset(atlas->advance, GLYPH_ATLAS_UNMEASURED, sizeof(atlas->advance));
+
+  for (int i = 0; i < GLYPH_ATLAS_CHARSET_SIZE; i++) {
+    atlas->advance[glyph_index(s_charset[i])] = measure_glyph(font, s_charset[i]);
+  }
+
+  // Insertion sort the charset by advance so equal widths form contiguous runs
+  for (int i = 0; i < GLYPH_ATLAS_CHARSET_SIZE; i++) {
+    char c = s_charset[i];
+    int j = i;
+    while (j > 0 && charset_advance(atlas, atlas->by_width[j - 1]) > charset_advance(atlas, c)) {
+      atlas->by_width[j] = atlas->by_width[j - 1];
+      j--;
+    }
+    atlas->by_width[j] = c;
+  }
+
+  int start = 0;
+  while (start < GLYPH_ATLAS_CHARSET_SIZE) {
+    uint8_t width = charset_advance(atlas, atlas->by_width[start]);
+    int end = start;
+    while (end < GLYPH_ATLAS_CHARSET_SIZE && charset_advance(atlas, atlas->by_width[end]) == width) end++;
+    for (int k = start; k < end; k++) {
+      int idx = charset_index(atlas->by_width[k]);
+      atlas->run_start[idx] = start;
+      atlas->run_length[idx] = end - start;
+    }
+    start = end;
+  }
+
+  atlas->built = true;
+}
+
+GlyphAtlas *glyph_atlas_for_font(GFont font) {
+  if (!font) return NULL;
+  for (int i = 0; i < GLYPH_ATLAS_MAX_FONTS; i++) {
+    if (s_atlases[i].built && s_atlases[i].font == font) return &s_atlases[i];
+  }
+  for (int i = 0; i < GLYPH_ATLAS_MAX_FONTS; i++) {
+    if (!s_atlases[i].built) {
+      build_atlas(&s_atlases[i], font);
+      return &s_atlases[i];
+    }
+  }
+  return NULL;
+}
+
+// Pick a random scramble glyph with the same advance as the target, so the
+// row keeps its final width for the whole animation. Targets outside the
+// charset (apostrophes, '%') fall back to any glyph.
+char glyph_atlas_scramble_char(const GlyphAtlas *atlas, char target) {
+  int idx = charset_index(target);
+  if (!atlas || idx < 0) {
+    return s_charset[rand() % GLYPH_ATLAS_CHARSET_SIZE];
+  }
+  return atlas->by_width[atlas->run_start[idx] + rand() % atlas->run_length[idx]];
+}
+
+// Single-line pixel width of text as the sum of its glyph advances.
+// System fonts carry no kerning, so this matches the text layout engine
+// without invoking it.
+int glyph_atlas_text_width(GlyphAtlas *atlas, const char *text) {
+  if (!atlas || !text) return 0;
+  int width = 0;
+  for (const char *c = text; *c; c++) {
+    int idx = glyph_index(*c);
+    if (idx < 0) continue;
+    if (atlas->advance[idx] == GLYPH_ATLAS_UNMEASURED) {
+      atlas->advance[idx] = measure_glyph(atlas->font, *c);
+    }
+    width += atlas->advance[idx];
+  }
+  return width;
+}
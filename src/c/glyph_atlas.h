@@ -0,0 +1,29 @@
+#pragma once
+
+#include <pebble.h>
+
+// Characters the hacker animation scrambles through
+#define GLYPH_ATLAS_CHARSET "abcdefghijklmnopqrstuvwxyz0123456789"
+#define GLYPH_ATLAS_CHARSET_SIZE 36
+
+// Advances are kept for printable ASCII; glyphs outside the scramble charset
+// are measured the first time a width query needs them
+#define GLYPH_ATLAS_FIRST_GLYPH ' '
+#define GLYPH_ATLAS_GLYPH_COUNT 95
+#define GLYPH_ATLAS_UNMEASURED 0xff
+
+// Per-font glyph advances, measured once. Scramble charset glyphs are also
+// grouped by advance so a scramble frame can swap in a character of the same
+// width and the row never reflows while it settles.
+typedef struct {
+  GFont font;
+  bool built;
+  uint8_t advance[GLYPH_ATLAS_GLYPH_COUNT];
+  char by_width[GLYPH_ATLAS_CHARSET_SIZE];      // charset sorted by advance
+  uint8_t run_start[GLYPH_ATLAS_CHARSET_SIZE];  // first same-width glyph in by_width
+  uint8_t run_length[GLYPH_ATLAS_CHARSET_SIZE]; // number of same-width glyphs
+} GlyphAtlas;
+
+GlyphAtlas *glyph_atlas_for_font(GFont font);
+char glyph_atlas_scramble_char(const GlyphAtlas *atlas, char target);
+int glyph_atlas_text_width(GlyphAtlas *atlas, const char *text);
@@ -207,4 +207,13 @@ void hour_to_24h_word(int hours, char *words) {
   strcpy(words, "");
 
   append_number(words, hours);
-}
\ No newline at end of file
+}
+
+
+// "forty two seconds", "one second"; "twenty three seconds" and the like need
+// 21 bytes with the terminator
+void seconds_to_words(int seconds, char *words, size_t size) {
+  char number[16] = "";
+  append_number(number, seconds);
+  snprintf(words, size, "%s %s", number, seconds == 1 ? "second" : "seconds");
+}
@@ -0,0 +1,34 @@
+#include "significance.h"
+
+void significance_reset(SignificanceFilter *filter) {
+  memset(filter, 0, sizeof(*filter));
+}
+
+static bool accept(SignificanceFilter *filter, time_t now) {
+  filter->held = 0;
+  filter->accepted_at = now;
+  return true;
+}
+
+bool significance_accept(SignificanceFilter *filter, const SignificancePolicy *policy,
+                         int32_t shown, int32_t value, bool urgent, time_t now) {
+  if (value == shown) {
+    // Back where it was: whatever was held was noise
+    filter->held = 0;
+    return false;
+  }
+  if (urgent) return accept(filter, now);
+
+  if (filter->accepted_at && now - filter->accepted_at < policy->min_interval_s) return false;
+
+  int32_t change = value > shown ? value - shown : shown - value;
+  if (change >= policy->min_change) return accept(filter, now);
+  if (policy->hold_count == 0) return false;
+
+  if (filter->held == 0 || filter->pending != value) {
+    filter->pending = value;
+    filter->held = 0;
+  }
+  filter->held++;
+  return filter->held >= policy->hold_count ? accept(filter, now) : false;
+}
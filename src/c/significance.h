@@ -0,0 +1,24 @@
+#pragma once
+
+#include <pebble.h>
+
+// When a new reading is worth showing. Changes of at least min_change are
+// shown; smaller ones only once the same value has been read hold_count times
+// in a row (0: never), which keeps a reading flapping at a threshold still.
+// Either way no more often than every min_interval_s, unless the reading is urgent
+typedef struct {
+  uint16_t min_change;
+  uint8_t hold_count;
+  uint16_t min_interval_s;
+} SignificancePolicy;
+
+typedef struct {
+  int32_t pending;      // small change waiting out hold_count
+  uint8_t held;         // readings of `pending` in a row
+  time_t accepted_at;   // when a reading last got through, 0 for never
+} SignificanceFilter;
+
+void significance_reset(SignificanceFilter *filter);
+// True if `value` should replace `shown` (and be animated and persisted)
+bool significance_accept(SignificanceFilter *filter, const SignificancePolicy *policy,
+                         int32_t shown, int32_t value, bool urgent, time_t now);
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <pebble.h>
+#include "glyph_atlas.h"
+#include "feature_profile.h"
+
+typedef struct {
+  char target_char, current_char;
+  int iterations_left;
+  bool locked;
+} HackerCharState;
+
+typedef struct {
+#if FEATURE_ANIMATION_HACKER
+  HackerCharState chars[ROW_TEXT_MAX];
+#endif
+  int target_length;
+  bool animating;
+  bool needs_initial_render;
+  char target_text[ROW_TEXT_MAX], display_buffer[ROW_TEXT_MAX];
+} HackerRowState;
+
+typedef struct {
+  TextLayer *label;
+  bool unchanged_font;
+  bool slide_pending, slide_out;
+  int left_pos, right_pos, still_pos, movement_delay;
+  GlyphAtlas *atlas;
+  Animation *slide_animation;
+  // target_text always holds the row's final text, whatever the animation style
+  HackerRowState hacker_state;
+} SlidingRow;
@@ -1,102 +1,159 @@
 #include <pebble.h>
 #include "num2words.h"
-
-// ============================================================================
-// ANIMATION CONFIGURATION - Change to ANIMATION_STYLE_SLIDE to revert
-// ============================================================================
-#define ANIMATION_STYLE_HACKER 1
-#define ANIMATION_STYLE_SLIDE 0
-#define ANIMATION_STYLE ANIMATION_STYLE_HACKER
-
-#define HACKER_ANIMATION_SPEED_MS 70
-#define HACKER_MAX_ITERATIONS 12
-#define HACKER_MIN_ITERATIONS 6
-#define HACKER_STARTUP_DELAY_MS 50
+#include "animation_engine.h"
+#include "trace.h"
+#include "sun_times.h"
+#include "worker_shared.h"
+#include "complications.h"
+#include "significance.h"
+#include "battery_history.h"
 
 static void window_appear_handler(Window *window);
 
 enum WeatherKey {
+  WEATHER_ICON_KEY = 0x0,
   WEATHER_TEMPERATURE_KEY = 0x1,
   WEATHER_CITY_KEY = 0x2,
+  WEATHER_REQUEST_STEPS_KEY = 0x3,
+  WEATHER_REQUEST_BATTERY_RATE_KEY = 0x4,
 };
 
 #define PERSIST_WEATHER_CONDITION 100
 #define PERSIST_WEATHER_TEMPERATURE 101
+#define PERSIST_ANIMATION_STYLE 102
+// 103 holds sun_times.c's cached sunrise/sunset, 105 the worker snapshot and
+// 106 complications.c's layout
+#define PERSIST_FLICK_SECONDS 107
+#define PERSIST_WEATHER_ICON 108
+// 109 holds battery_history.c's ring
+#define PERSIST_BATTERY_TIME_LEFT 110
+#define PERSIST_FUZZY_TIME 111
+
+// Fuzzy time rounds to the nearest five minutes, so what it shows changes two
+// minutes before each multiple of five: at :03, :08 and so on
+#define FUZZY_STEP_MINUTES 5
+#define FUZZY_LEAD_MINUTES 2
+
+// last_temperature before any reading arrived
+#define TEMPERATURE_NONE 999
+
+#if FEATURE_WEATHER_ICONS
+// Indexed by the icon pkjs sends, see iconFromWeatherId() and tools/weather_icons.py
+static const uint32_t s_weather_icon_resources[] = {
+  RESOURCE_ID_WEATHER_CLEAR, RESOURCE_ID_WEATHER_CLOUDS, RESOURCE_ID_WEATHER_RAIN, RESOURCE_ID_WEATHER_SNOW
+};
+#define WEATHER_ICON_COUNT ((int)(sizeof(s_weather_icon_resources) / sizeof(s_weather_icon_resources[0])))
+#define WEATHER_ICON_SIZE 18
+#define WEATHER_ICON_GAP 3
+#endif
+
+// Battery moves in 5% steps unless it's low or charging, a degree either way
+// only shows once it has held for three refreshes, steps at most every 5 minutes
+#define BATTERY_LOW_PERCENT 20
+static const SignificancePolicy s_battery_policy = { .min_change = 5 };
+static const SignificancePolicy s_temperature_policy = { .min_change = 2, .hold_count = 3 };
+#if FEATURE_HEALTH
+static const SignificancePolicy s_steps_policy = { .min_change = 1, .min_interval_s = 5 * 60 };
+#endif
+#if FEATURE_HEART_RATE
+// A few beats either way is noise from one sample to the next
+static const SignificancePolicy s_heart_rate_policy = { .min_change = 4, .hold_count = 2, .min_interval_s = 60 };
+#endif
 
 static void request_weather(void);
 static void make_animation(void);
 static void update_time_display(void);
 
-typedef enum { MOVING_IN, IN_FRAME, PREPARE_TO_MOVE, MOVING_OUT } SlideState;
-
-typedef struct {
-  char target_char, current_char;
-  int iterations_left;
-  bool locked;
-} HackerCharState;
-
-typedef struct {
-  HackerCharState chars[64];
-  int target_length;
-  bool animating;
-  bool needs_initial_render;
-  char target_text[64], display_buffer[64];
-} HackerRowState;
-
+// A complication's row only exists while the layout places it somewhere
 typedef struct {
-  TextLayer *label;
-  SlideState state;
-  char *next_string;
-  bool unchanged_font;
-  int left_pos, right_pos, still_pos, movement_delay, delay_count;
-  HackerRowState hacker_state;
-} SlidingRow;
+  SlidingRow row;
+  char text[2][ROW_TEXT_MAX];
+  uint8_t next;
+} ComplicationRow;
 
 typedef struct {
-  SlidingRow day_row, hour_row, first_minute_row, second_minute_row, date_row, battery_row, weather_row, weather_condition_row, steps_row;
-  int last_hour, last_minute, last_day, last_battery, last_temperature, last_steps, last_step_update_minute;
-  bool weather_changed;
+  SlidingRow hour_row, first_minute_row, second_minute_row;
+  ComplicationRow *complications[COMPLICATION_COUNT];   // NULL while off
+  Layout layout;
+  int last_hour, last_minute, last_day, last_battery, last_temperature, last_steps;
+  int last_tick_minute;       // minute of the day at the previous tick
+  SignificanceFilter battery_filter, temperature_filter, steps_filter;
+  int last_request_steps;
+  int last_sun_event;
+  char weather_condition[32];
+  bool battery_shown;         // the row is placed; the service stays on for the history
+  bool battery_time_left;     // the setting: time left rather than percent, once measured
+  bool steps_subscribed;
+  bool steps_from_worker;     // the background worker reports steps, no health subscription here
+  bool heart_rate_subscribed;
+  bool health_subscribed;     // steps without the worker and heart rate share it
+#if FEATURE_HEART_RATE
+  struct {
+    int bpm;                  // shown, -1 before the first sample
+    SignificanceFilter filter;
+    int32_t window_steps;     // daily step total when the cadence window started
+    int32_t latest_steps;
+    time_t window_start;
+    bool active;              // walking fast enough for frequent samples
+    bool in_focus;
+    uint16_t period_s;        // sample period asked of the HRM, 0 for the system default
+  } heart_rate;
+#endif
+#if FEATURE_WEATHER_ICONS
+  struct {
+    int id;                   // last sent by pkjs, -1 before any
+    Layer *layer;             // at the outer end of the condition's slot while it's placed
+    GDrawCommandImage *image; // the one icon kept loaded, for id
+  } icon;
+#endif
+  struct {
+    bool enabled;             // the setting; while on there is no minute tick
+    AppTimer *timer;          // the next change of the rounded time
+    AppTimer *day_timer;      // the next midnight, for the day and date lines
+  } fuzzy;
+#if FEATURE_FLICK_SECONDS
+  struct {
+    bool enabled;             // the setting; while off nothing is created or subscribed
+    TextLayer *label;         // stands in for the bottom line while showing
+    time_t until;             // end of the window, 0 when not showing
+    char text[24];
+  } flick;
+#endif
   bool window_ready;
   GFont bitham42_bold, bitham42_light, gothic18_bold, gothic18;
   Window *window;
-  AppTimer *hacker_timer;
+  time_t day_time;            // the day and date rows describe this instead of now, 0 for now
+  // Slot [next_*] is the spare one. Once an animation settles it is filled for the
+  // coming minute, as are the spare texts of lines the coming minute changes
   struct {
-    char hours[2][32], first_minutes[2][32], second_minutes[2][32], days[2][32], dates[2][32];
-    char battery[2][64], temperature[2][32], weather_condition[2][32], steps[2][32];
-    uint8_t next_hours, next_minutes, next_days, next_dates, next_battery, next_temperature, next_weather_condition, next_steps;
+    char hours[2][32], first_minutes[2][32], second_minutes[2][32];
+    uint8_t next_hours, next_minutes;
+    time_t prepared_minute;         // start of the minute the spare slots hold, 0 for none
+    bool hours_prepared;            // that minute starts a new hour
+    uint8_t prepared_lines;         // complication lines laid out for it, by bit
+    uint16_t prepared_complications; // complications whose spare text differs, by bit
   } render_state;
-  // Track collapse state for each line pair
-  struct {
-    bool day_collapsed;        // Line 1: temperature (left) vs day (right)
-    bool date_collapsed;       // Line 2: weather condition (left) vs date (right)
-    bool battery_collapsed;    // Line 6: steps (left) vs battery (right)
-  } collapse_state;
 } SlidingTextData;
 
 SlidingTextData *s_data;
 
-// Forward declarations - needed for collapse/uncollapse system
+// Forward declarations
 static void slide_in_text(SlidingTextData *data, SlidingRow *row, char* new_text, bool force_animate);
 static void day_to_word(int day, char *buffer);
 static void day_of_month_to_words(int day, char *buffer);
 static void number_to_words(int num, char *buffer);
 static int get_screen_width(SlidingTextData *data);
-static bool would_collide_with_font(const char *left_text, const char *right_text, GFont left_font, GFont right_font, int screen_width);
+static bool would_collide_with_font(const char *left_text, const char *right_text, GlyphAtlas *left_atlas, GlyphAtlas *right_atlas, int screen_width);
 static void day_to_short(int day, char *buffer);
 static void date_to_short(int day, char *buffer);
 static void battery_to_short(int percent, char *buffer);
-static bool check_line1_collision(SlidingTextData *data, const char *temp_text, const char *day_full_text);
-static bool check_line2_collision(SlidingTextData *data, const char *cond_text, const char *date_full_text);
-static bool check_line6_collision(SlidingTextData *data, const char *steps_text, const char *battery_full_text);
-static void collapse_line1_right(SlidingTextData *data, int day);
-static void uncollapse_line1_right(SlidingTextData *data, int day);
-static void collapse_line2_right(SlidingTextData *data, int date);
-static void uncollapse_line2_right(SlidingTextData *data, int date);
-static void collapse_line6_right(SlidingTextData *data, int battery_percent);
-static void uncollapse_line6_right(SlidingTextData *data, int battery_percent);
-static void handle_line1_update(SlidingTextData *data, const char *temp_text, int day);
-static void handle_line2_update(SlidingTextData *data, const char *cond_text, int date);
-static void handle_line6_update(SlidingTextData *data, const char *steps_text, int battery_percent);
+static void time_left_to_text(int minutes, bool collapsed, char *buffer);
+static void steps_to_significant_figure(int steps, char *buffer);
+static void sun_event_to_text(int event, bool digits, char *buffer, size_t size);
+#if FEATURE_HEART_RATE
+static void update_heart_rate_cadence(SlidingTextData *data);
+#endif
+static void handle_minute_tick(struct tm *tick_time, TimeUnits units_changed);
 
 // Check if we're in night mode (midnight to 6am) where animations are disabled to save battery
 static bool is_night_mode(void) {
@@ -110,32 +167,34 @@ static void day_to_word(int day, char *buffer) {
   strcpy(buffer, days[day]);
 }
 
-static bool would_collide_with_font(const char *left_text, const char *right_text, GFont left_font, GFont right_font, int screen_width) {
-  if (!left_text || !right_text || strlen(left_text) == 0 || strlen(right_text) == 0) return false;
-  
-  // Measure actual text widths
-  GSize left_size = graphics_text_layout_get_content_size(left_text, left_font, GRect(0, 0, screen_width, 100), GTextOverflowModeWordWrap, GTextAlignmentLeft);
-  GSize right_size = graphics_text_layout_get_content_size(right_text, right_font, GRect(0, 0, screen_width, 100), GTextOverflowModeWordWrap, GTextAlignmentLeft);
-  
+static bool would_collide_with_font(const char *left_text, const char *right_text, GlyphAtlas *left_atlas, GlyphAtlas *right_atlas, int screen_width) {
+  if (!left_text || !right_text || !left_text[0] || !right_text[0]) return false;
+
+  // Text widths are sums of cached glyph advances - no layout engine calls
+  int left_width = glyph_atlas_text_width(left_atlas, left_text);
+  int right_width = glyph_atlas_text_width(right_atlas, right_text);
+
   // Conservative collision detection:
-  // Left text: starts at x=2, width = left_size.w
-  // Right text: right-aligned, ends at x=(screen_width-5), width = right_size.w
-  // 
-  // Right text starts at x = (screen_width - 5 - right_size.w)
-  // Left text ends at x = (2 + left_size.w)
-  // Collision if: (2 + left_size.w) + gap > (screen_width - 5 - right_size.w)
-  // 
+  // Left text: starts at x=2, width = left_width
+  // Right text: right-aligned, ends at x=(screen_width-5), width = right_width
+  //
+  // Right text starts at x = (screen_width - 5 - right_width)
+  // Left text ends at x = (2 + left_width)
+  // Collision if: (2 + left_width) + gap > (screen_width - 5 - right_width)
+  //
   // Only consider it a collision if they would actually overlap (very tight)
   int min_gap = 8;  // Very minimal gap - only collapse if truly overlapping
-  return (left_size.w + right_size.w + min_gap) > (screen_width - 2);
+  return (left_width + right_width + min_gap) > (screen_width - 2);
 }
 
+// Rows span the display, so the width is known without waiting for the window
 static int get_screen_width(SlidingTextData *data) {
-  return layer_get_bounds(window_get_root_layer(data->window)).size.w;
+  (void) data;
+  return PBL_DISPLAY_WIDTH;
 }
 
 // ============================================================================
-// COLLISION DETECTION & COLLAPSE/UNCOLLAPSE SYSTEM
+// WORDS
 // ============================================================================
 
 // Get the SHORT form of a day name (e.g., "wednesday" -> "wed")
@@ -158,148 +217,26 @@ static void battery_to_short(int percent, char *buffer) {
   snprintf(buffer, 64, "%d%%", percent);
 }
 
-// Check if line 1 (temperature left, day right) would collide
-// Returns true if collision detected
-static bool check_line1_collision(SlidingTextData *data, const char *temp_text, const char *day_full_text) {
-  if (!data->window_ready || !temp_text || !day_full_text) return false;
-  int screen_width = get_screen_width(data);
-  return would_collide_with_font(temp_text, day_full_text, data->gothic18_bold, data->gothic18_bold, screen_width);
-}
-
-// Check if line 2 (weather condition left, date right) would collide
-// Returns true if collision detected
-static bool check_line2_collision(SlidingTextData *data, const char *cond_text, const char *date_full_text) {
-  if (!data->window_ready || !cond_text || !date_full_text) return false;
-  int screen_width = get_screen_width(data);
-  return would_collide_with_font(cond_text, date_full_text, data->gothic18, data->gothic18, screen_width);
-}
-
-// Check if line 6 (steps left, battery right) would collide
-// Returns true if collision detected
-static bool check_line6_collision(SlidingTextData *data, const char *steps_text, const char *battery_full_text) {
-  if (!data->window_ready || !steps_text || !battery_full_text) return false;
-  int screen_width = get_screen_width(data);
-  return would_collide_with_font(steps_text, battery_full_text, data->gothic18_bold, data->gothic18, screen_width);
-}
-
-// Collapse line 1 right text (day name to abbreviation)
-static void collapse_line1_right(SlidingTextData *data, int day) {
-  char short_day[32];
-  day_to_short(day, short_day);
-  strcpy(data->render_state.days[data->render_state.next_days], short_day);
-  slide_in_text(data, &data->day_row, short_day, false);
-  data->render_state.next_days = data->render_state.next_days ? 0 : 1;
-  data->collapse_state.day_collapsed = true;
-}
-
-// Uncollapse line 1 right text (abbreviated day to full name)
-static void uncollapse_line1_right(SlidingTextData *data, int day) {
-  char full_day[32];
-  day_to_word(day, full_day);
-  strcpy(data->render_state.days[data->render_state.next_days], full_day);
-  slide_in_text(data, &data->day_row, full_day, false);
-  data->render_state.next_days = data->render_state.next_days ? 0 : 1;
-  data->collapse_state.day_collapsed = false;
-}
-
-// Collapse line 2 right text (full date to numeric)
-static void collapse_line2_right(SlidingTextData *data, int date) {
-  char short_date[32];
-  date_to_short(date, short_date);
-  strcpy(data->render_state.dates[data->render_state.next_dates], short_date);
-  slide_in_text(data, &data->date_row, short_date, false);
-  data->render_state.next_dates = data->render_state.next_dates ? 0 : 1;
-  data->collapse_state.date_collapsed = true;
-}
-
-// Uncollapse line 2 right text (numeric date to full name)
-static void uncollapse_line2_right(SlidingTextData *data, int date) {
-  char full_date[32];
-  day_of_month_to_words(date, full_date);
-  strcpy(data->render_state.dates[data->render_state.next_dates], full_date);
-  slide_in_text(data, &data->date_row, full_date, false);
-  data->render_state.next_dates = data->render_state.next_dates ? 0 : 1;
-  data->collapse_state.date_collapsed = false;
-}
-
-// Collapse line 6 right text (battery words to percentage)
-static void collapse_line6_right(SlidingTextData *data, int battery_percent) {
-  char short_battery[64];
-  battery_to_short(battery_percent, short_battery);
-  strcpy(data->render_state.battery[data->render_state.next_battery], short_battery);
-  slide_in_text(data, &data->battery_row, short_battery, false);
-  data->render_state.next_battery = data->render_state.next_battery ? 0 : 1;
-  data->collapse_state.battery_collapsed = true;
-}
-
-// Uncollapse line 6 right text (percentage to battery words)
-static void uncollapse_line6_right(SlidingTextData *data, int battery_percent) {
-  char full_battery[64];
-  char num_words[64];
-  number_to_words(battery_percent, num_words);
-  snprintf(full_battery, 64, "%s pc", num_words);
-  strcpy(data->render_state.battery[data->render_state.next_battery], full_battery);
-  slide_in_text(data, &data->battery_row, full_battery, false);
-  data->render_state.next_battery = data->render_state.next_battery ? 0 : 1;
-  data->collapse_state.battery_collapsed = false;
-}
-
-// Handle line 1 collision: evaluate if collapse/uncollapse is needed
-// Called whenever temperature or day updates
-static void handle_line1_update(SlidingTextData *data, const char *temp_text, int day) {
-  time_t now = time(NULL);
-  struct tm t = *localtime(&now);
-  
-  char full_day[32];
-  day_to_word(t.tm_wday, full_day);
-  
-  bool collision = check_line1_collision(data, temp_text, full_day);
-  
-  if (collision && !data->collapse_state.day_collapsed) {
-    // Collision detected and not collapsed -> collapse it
-    collapse_line1_right(data, day);
-  } else if (!collision && data->collapse_state.day_collapsed) {
-    // No collision detected and is collapsed -> try to uncollapse it
-    uncollapse_line1_right(data, day);
-  }
-}
-
-// Handle line 2 collision: evaluate if collapse/uncollapse is needed
-// Called whenever weather condition or date updates
-static void handle_line2_update(SlidingTextData *data, const char *cond_text, int date) {
-  time_t now = time(NULL);
-  struct tm t = *localtime(&now);
-  
-  char full_date[32];
-  day_of_month_to_words(t.tm_mday, full_date);
-  
-  bool collision = check_line2_collision(data, cond_text, full_date);
-  
-  if (collision && !data->collapse_state.date_collapsed) {
-    // Collision detected and not collapsed -> collapse it
-    collapse_line2_right(data, date);
-  } else if (!collision && data->collapse_state.date_collapsed) {
-    // No collision detected and is collapsed -> try to uncollapse it
-    uncollapse_line2_right(data, date);
-  }
-}
-
-// Handle line 6 collision: evaluate if collapse/uncollapse is needed
-// Called whenever steps or battery updates
-static void handle_line6_update(SlidingTextData *data, const char *steps_text, int battery_percent) {
-  char full_battery[64];
-  char num_words[64];
-  number_to_words(battery_percent, num_words);
-  snprintf(full_battery, 64, "%s pc", num_words);
-  
-  bool collision = check_line6_collision(data, steps_text, full_battery);
-  
-  if (collision && !data->collapse_state.battery_collapsed) {
-    // Collision detected and not collapsed -> collapse it
-    collapse_line6_right(data, battery_percent);
-  } else if (!collision && data->collapse_state.battery_collapsed) {
-    // No collision detected and is collapsed -> try to uncollapse it
-    uncollapse_line6_right(data, battery_percent);
+// "two days left", "nine hours left", "forty min left"; "2d left" when collapsed
+static void time_left_to_text(int minutes, bool collapsed, char *buffer) {
+  int amount = minutes;
+  const char *unit = collapsed ? "m" : " min";
+  if (minutes >= 48 * 60) {
+    amount = minutes / (24 * 60);
+    unit = collapsed ? "d" : " days";
+  } else if (minutes >= 120) {
+    amount = minutes / 60;
+    unit = collapsed ? "h" : " hours";
+  } else if (minutes >= 60) {
+    amount = 1;
+    unit = collapsed ? "h" : " hour";
+  }
+  if (collapsed) {
+    snprintf(buffer, ROW_TEXT_MAX, "%d%s left", amount, unit);
+  } else {
+    char num_words[32];
+    number_to_words(amount, num_words);
+    snprintf(buffer, ROW_TEXT_MAX, "%s%s left", num_words, unit);
   }
 }
 
@@ -307,16 +244,24 @@ static void number_to_words(int num, char *buffer) {
   const char *ones[] = {"", "one", "two", "three", "four", "five", "six", "seven", "eight", "nine"};
   const char *teens[] = {"ten", "eleven", "twelve", "thirteen", "fourteen", "fifteen", "sixteen", "seventeen", "eighteen", "nineteen"};
   const char *tens[] = {"", "", "twenty", "thirty", "forty", "fifty", "sixty", "seventy", "eighty", "ninety"};
-  
+
   // Handle negative numbers
   if (num < 0) {
     strcpy(buffer, "minus ");
     number_to_words(-num, buffer + 6);  // Recursively convert the positive part
     return;
   }
-  
+
   if (num == 0) strcpy(buffer, "zero");
-  else if (num == 100) strcpy(buffer, "one hundred");
+  else if (num >= 100) {
+    // Heart rates go past a hundred: "one hundred twelve"
+    number_to_words(num / 100, buffer);
+    strcat(buffer, " hundred");
+    if (num % 100) {
+      strcat(buffer, " ");
+      number_to_words(num % 100, buffer + strlen(buffer));
+    }
+  }
   else if (num < 10) strcpy(buffer, ones[num]);
   else if (num < 20) strcpy(buffer, teens[num - 10]);
   else if (num < 100) {
@@ -330,7 +275,7 @@ static void steps_to_significant_figure(int steps, char *buffer) {
   const char *ones[] = {"zero", "one", "two", "three", "four", "five", "six", "seven", "eight", "nine"};
   const char *teens[] = {"ten", "eleven", "twelve", "thirteen", "fourteen", "fifteen", "sixteen", "seventeen", "eighteen", "nineteen"};
   const char *tens[] = {"", "", "twenty", "thirty", "forty", "fifty", "sixty", "seventy", "eighty", "ninety"};
-  
+
   if (steps == 0) strcpy(buffer, "zero s");
   else if (steps < 10) snprintf(buffer, 32, "%s s", ones[steps]);
   else if (steps < 20) strcpy(buffer, ((steps + 5) / 10 == 1) ? "one ds" : "two ds");
@@ -357,7 +302,7 @@ static void day_of_month_to_words(int day, char *buffer) {
   const char *teen_ths[] = {"tenth", "eleventh", "twelfth", "thirteenth", "fourteenth", "fifteenth", "sixteenth", "seventeenth", "eighteenth", "nineteenth"};
   const char *ten_ths[] = {"", "", "twentieth", "thirtieth", "fortieth", "fiftieth", "sixtieth", "seventieth", "eightieth", "ninetieth"};
   const char *tens[] = {"", "", "twenty", "thirty"};
-  
+
   if (day >= 1 && day <= 9) strcpy(buffer, firsts[day - 1]);
   else if (day >= 10 && day <= 19) strcpy(buffer, teen_ths[day - 10]);
   else if (day >= 20 && day <= 31) {
@@ -367,95 +312,225 @@ static void day_of_month_to_words(int day, char *buffer) {
   } else strcpy(buffer, "first");
 }
 
-static char get_random_char(void) {
-  const char charset[] = "abcdefghijklmnopqrstuvwxyz0123456789";
-  return charset[rand() % (sizeof(charset) - 1)];
-}
-
-static void start_hacker_animation(SlidingRow *row, const char *target_text, bool fast_mode, bool force_animate) {
-  HackerRowState *hs = &row->hacker_state;
-  const char *current_text = text_layer_get_text(row->label);
-  bool has_existing = current_text && strlen(current_text) > 0 && !force_animate;
-  
-  strncpy(hs->target_text, target_text, 63);
-  hs->target_text[63] = '\0';
-  hs->target_length = strlen(hs->target_text);
-  hs->animating = true;
-  hs->needs_initial_render = true;
-  
-  // Normalize iteration counts: use same base for all rows to sync animation end times
-  // Fast mode still gets fewer iterations but the range is tighter
-  int min_iter = fast_mode ? 3 : HACKER_MIN_ITERATIONS;
-  int max_iter = fast_mode ? 5 : HACKER_MAX_ITERATIONS;
-  
-  for (int i = 0; i < hs->target_length; i++) {
-    hs->chars[i].target_char = hs->target_text[i];
-    
-    if (has_existing && i < (int)strlen(current_text)) {
-      hs->chars[i].current_char = current_text[i];
-      hs->chars[i].locked = (current_text[i] == hs->target_text[i]);
-      hs->chars[i].iterations_left = hs->chars[i].locked ? 0 : min_iter;
-    } else {
-      hs->chars[i].current_char = get_random_char();
-      hs->chars[i].locked = false;
-    }
-    
-    if (!hs->chars[i].locked) {
-      float progress = (float)i / (hs->target_length > 1 ? hs->target_length - 1 : 1);
-      int base_iter = min_iter + (int)(progress * (max_iter - min_iter));
-      hs->chars[i].iterations_left = base_iter + (rand() % 2);
-      if (hs->chars[i].iterations_left < min_iter) hs->chars[i].iterations_left = min_iter;
-    }
-    
-    if (hs->target_text[i] == ' ') {
-      hs->chars[i].current_char = ' ';
-      hs->chars[i].locked = true;
-      hs->chars[i].iterations_left = 0;
+// ============================================================================
+// COMPLICATION REGISTRY
+// ============================================================================
+
+// Each formatter fills the full text, or the short form when `collapsed`;
+// false while there is nothing to show yet
+static bool format_weather(SlidingTextData *data, bool collapsed, char *buffer) {
+  (void) collapsed;
+  if (data->last_temperature == TEMPERATURE_NONE) return false;
+  char temp_words[32];
+  number_to_words(data->last_temperature, temp_words);
+  snprintf(buffer, 32, "%s c", temp_words);
+  return true;
+}
+
+static bool format_condition(SlidingTextData *data, bool collapsed, char *buffer) {
+  (void) collapsed;
+  if (!data->weather_condition[0]) return false;
+  strcpy(buffer, data->weather_condition);
+  return true;
+}
+
+static bool format_steps(SlidingTextData *data, bool collapsed, char *buffer) {
+  (void) collapsed;
+  if (data->last_steps < 0) return false;
+  steps_to_significant_figure(data->last_steps, buffer);
+  return true;
+}
+
+// "forty five pc", or "45%" when collapsed; the time left instead when that
+// is set and the rate has been measured, but never while charging
+static bool format_battery(SlidingTextData *data, bool collapsed, char *buffer) {
+  if (data->last_battery < 0) return false;
+  int minutes_left = data->battery_time_left ? battery_history_minutes_left(time(NULL)) : -1;
+  if (minutes_left >= 0) {
+    time_left_to_text(minutes_left, collapsed, buffer);
+  } else if (collapsed) {
+    battery_to_short(data->last_battery, buffer);
+  } else {
+    char num_words[64];
+    number_to_words(data->last_battery, num_words);
+    snprintf(buffer, 64, "%s pc", num_words);
+  }
+  return true;
+}
+
+static bool format_day(SlidingTextData *data, bool collapsed, char *buffer) {
+  time_t now = data->day_time ? data->day_time : time(NULL);
+  struct tm t = *localtime(&now);
+  if (collapsed) day_to_short(t.tm_wday, buffer);
+  else day_to_word(t.tm_wday, buffer);
+  return true;
+}
+
+static bool format_date(SlidingTextData *data, bool collapsed, char *buffer) {
+  time_t now = data->day_time ? data->day_time : time(NULL);
+  struct tm t = *localtime(&now);
+  if (collapsed) date_to_short(t.tm_mday, buffer);
+  else day_of_month_to_words(t.tm_mday, buffer);
+  return true;
+}
+
+static bool format_sun(SlidingTextData *data, bool collapsed, char *buffer) {
+  if (data->last_sun_event < 0) return false;
+  sun_event_to_text(data->last_sun_event, collapsed, buffer, ROW_TEXT_MAX);
+  return true;
+}
+
+#if FEATURE_HEART_RATE
+// "seventy two bpm", or "72 bpm" when collapsed
+static bool format_heart_rate(SlidingTextData *data, bool collapsed, char *buffer) {
+  if (data->heart_rate.bpm < 0) return false;
+  if (collapsed) {
+    snprintf(buffer, ROW_TEXT_MAX, "%d bpm", data->heart_rate.bpm);
+  } else {
+    char num_words[64];
+    number_to_words(data->heart_rate.bpm, num_words);
+    snprintf(buffer, ROW_TEXT_MAX, "%s bpm", num_words);
+  }
+  return true;
+}
+#endif
+
+typedef struct {
+  bool bold;      // gothic 18 bold rather than regular
+  bool wide;      // on the left it may run most of the line rather than three quarters
+  // The buffer holds at least ROW_TEXT_MAX, all the row itself keeps
+  bool (*format)(SlidingTextData *data, bool collapsed, char *buffer);
+} ComplicationSpec;
+
+static const ComplicationSpec s_complication_specs[COMPLICATION_COUNT] = {
+  [COMPLICATION_WEATHER] = { .bold = true, .format = format_weather },
+  [COMPLICATION_CONDITION] = { .bold = false, .format = format_condition },
+  [COMPLICATION_STEPS] = { .bold = true, .format = format_steps },
+  [COMPLICATION_BATTERY] = { .bold = false, .format = format_battery },
+  [COMPLICATION_DAY] = { .bold = true, .format = format_day },
+  [COMPLICATION_DATE] = { .bold = false, .format = format_date },
+  [COMPLICATION_SUN] = { .bold = true, .wide = true, .format = format_sun },
+#if FEATURE_HEART_RATE
+  [COMPLICATION_HEART_RATE] = { .bold = false, .format = format_heart_rate },
+#endif
+};
+
+static bool complication_enabled(SlidingTextData *data, Complication complication) {
+  return data->complications[complication] != NULL;
+}
+
+// Fill the row's spare buffer; false when the row already shows that text
+static bool stage_complication_text(ComplicationRow *row, const char *text) {
+  uint8_t current = row->next ? 0 : 1;
+  if (strncmp(row->text[current], text, ROW_TEXT_MAX - 1) == 0) return false;
+  strncpy(row->text[row->next], text, ROW_TEXT_MAX - 1);
+  row->text[row->next][ROW_TEXT_MAX - 1] = '\0';
+  return true;
+}
+
+// Bring in what stage_complication_text() left in the spare buffer
+static void commit_complication_text(SlidingTextData *data, ComplicationRow *row) {
+  // Until the window appears only the buffer changes; the appear handler animates it in
+  if (data->window_ready) slide_in_text(data, &row->row, row->text[row->next], false);
+  row->next = row->next ? 0 : 1;
+}
+
+static void set_complication_text(SlidingTextData *data, Complication complication, const char *text) {
+  ComplicationRow *row = data->complications[complication];
+  if (stage_complication_text(row, text)) commit_complication_text(data, row);
+}
+
+// Format one line: when the pair would overlap, shorten the right side first
+// and then the left, so "twenty one c / wednesday" becomes ".../ wed".
+// A side with nothing to show is left empty
+static void lay_out_line(SlidingTextData *data, int line, char *left_text, char *right_text) {
+  Complication left = layout_complication_at(&data->layout, SLOT_LEFT(line));
+  Complication right = layout_complication_at(&data->layout, SLOT_RIGHT(line));
+  bool has_left = left != COMPLICATION_COUNT && s_complication_specs[left].format(data, false, left_text);
+  bool has_right = right != COMPLICATION_COUNT && s_complication_specs[right].format(data, false, right_text);
+
+  if (has_left && has_right) {
+    GlyphAtlas *left_atlas = data->complications[left]->row.atlas;
+    GlyphAtlas *right_atlas = data->complications[right]->row.atlas;
+    int screen_width = get_screen_width(data);
+#if FEATURE_WEATHER_ICONS
+    if ((left == COMPLICATION_CONDITION || right == COMPLICATION_CONDITION) && data->icon.layer) {
+      screen_width -= WEATHER_ICON_SIZE + WEATHER_ICON_GAP;
     }
-    
-    // Build initial display buffer
-    hs->display_buffer[i] = hs->chars[i].locked ? hs->chars[i].target_char : hs->chars[i].current_char;
-  }
-  hs->display_buffer[hs->target_length] = '\0';
-  
-  // Immediately render the initial scrambled state - no waiting for timer
-  text_layer_set_text(row->label, hs->display_buffer);
-}
-
-static bool update_hacker_animation(SlidingRow *row) {
-  HackerRowState *hs = &row->hacker_state;
-  if (!hs->animating) return false;
-  
-  bool any_unlocked = false;
-  for (int i = 0; i < hs->target_length; i++) {
-    if (hs->chars[i].locked) {
-      hs->display_buffer[i] = hs->chars[i].target_char;
-    } else {
-      any_unlocked = true;
-      if (hs->chars[i].iterations_left <= 0) {
-        hs->chars[i].current_char = hs->chars[i].target_char;
-        hs->chars[i].locked = true;
-        hs->display_buffer[i] = hs->chars[i].target_char;
-      } else {
-        hs->chars[i].iterations_left--;
-        hs->chars[i].current_char = get_random_char();
-        hs->display_buffer[i] = hs->chars[i].current_char;
+#endif
+    if (would_collide_with_font(left_text, right_text, left_atlas, right_atlas, screen_width)) {
+      s_complication_specs[right].format(data, true, right_text);
+      if (would_collide_with_font(left_text, right_text, left_atlas, right_atlas, screen_width)) {
+        s_complication_specs[left].format(data, true, left_text);
       }
     }
   }
-  
-  hs->display_buffer[hs->target_length] = '\0';
-  text_layer_set_text(row->label, hs->display_buffer);
-  
-  if (!any_unlocked) {
-    hs->animating = false;
-    text_layer_set_text(row->label, hs->target_text);
+
+  if (!has_left) left_text[0] = '\0';
+  if (!has_right) right_text[0] = '\0';
+}
+
+static void refresh_line(SlidingTextData *data, int line) {
+  Complication left = layout_complication_at(&data->layout, SLOT_LEFT(line));
+  Complication right = layout_complication_at(&data->layout, SLOT_RIGHT(line));
+  // Whatever was laid out ahead for this line is out of date now; once this
+  // change has animated the idle handler prepares the coming minute again
+  if (data->render_state.prepared_lines & (1 << line)) {
+    data->render_state.prepared_lines &= ~(1 << line);
+    data->render_state.prepared_complications &= ~((1 << left) | (1 << right));
+    data->render_state.prepared_minute = 0;
+  }
+
+  char left_text[64] = "", right_text[64] = "";
+  lay_out_line(data, line, left_text, right_text);
+  if (left_text[0]) set_complication_text(data, left, left_text);
+  if (right_text[0]) set_complication_text(data, right, right_text);
+}
+
+// Lay a line out ahead of time into its rows' spare buffers, for commit_line()
+static void prepare_line(SlidingTextData *data, int line) {
+  char texts[2][64] = { "", "" };
+  lay_out_line(data, line, texts[0], texts[1]);
+  for (int side = 0; side < 2; side++) {
+    Complication complication = layout_complication_at(&data->layout, side ? SLOT_RIGHT(line) : SLOT_LEFT(line));
+    if (texts[side][0] && stage_complication_text(data->complications[complication], texts[side])) {
+      data->render_state.prepared_complications |= 1 << complication;
+    }
   }
-  
-  return any_unlocked;
+  data->render_state.prepared_lines |= 1 << line;
 }
 
-static void init_sliding_row(SlidingTextData *data, SlidingRow *row, GRect pos, GFont font, int delay) {
+static void commit_line(SlidingTextData *data, int line) {
+  for (int side = 0; side < 2; side++) {
+    Complication complication = layout_complication_at(&data->layout, side ? SLOT_RIGHT(line) : SLOT_LEFT(line));
+    if (complication == COMPLICATION_COUNT) continue;
+    if (data->render_state.prepared_complications & (1 << complication)) {
+      data->render_state.prepared_complications &= ~(1 << complication);
+      commit_complication_text(data, data->complications[complication]);
+    }
+  }
+  data->render_state.prepared_lines &= ~(1 << line);
+}
+
+static bool line_shows_day(SlidingTextData *data, int line) {
+  Complication left = layout_complication_at(&data->layout, SLOT_LEFT(line));
+  Complication right = layout_complication_at(&data->layout, SLOT_RIGHT(line));
+  return left == COMPLICATION_DAY || left == COMPLICATION_DATE ||
+         right == COMPLICATION_DAY || right == COMPLICATION_DATE;
+}
+
+// A complication's value changed: redo its line, nothing if it's off
+static void refresh_complication(SlidingTextData *data, Complication complication) {
+  Slot slot = layout_slot_of(&data->layout, complication);
+  if (slot == SLOT_OFF) return;
+  refresh_line(data, SLOT_LINE(slot));
+}
+
+// ============================================================================
+// ROWS
+// ============================================================================
+
+static void init_sliding_row(SlidingRow *row, GRect pos, GFont font, int delay) {
   row->label = text_layer_create(pos);
   text_layer_set_text_alignment(row->label, PBL_IF_ROUND_ELSE(GTextAlignmentCenter, GTextAlignmentLeft));
   text_layer_set_background_color(row->label, GColorClear);
@@ -464,448 +539,1004 @@ static void init_sliding_row(SlidingTextData *data, SlidingRow *row, GRect pos,
     text_layer_set_font(row->label, font);
     row->unchanged_font = true;
   } else row->unchanged_font = false;
+  row->atlas = glyph_atlas_for_font(font);
 
-  row->state = IN_FRAME;
-  row->next_string = NULL;
   row->left_pos = -pos.size.w;
   row->right_pos = pos.size.w;
   row->still_pos = pos.origin.x;
   row->movement_delay = delay;
-  row->delay_count = 0;
   row->hacker_state.animating = false;
   row->hacker_state.needs_initial_render = false;
   row->hacker_state.target_length = 0;
   memset(row->hacker_state.target_text, 0, sizeof(row->hacker_state.target_text));
   memset(row->hacker_state.display_buffer, 0, sizeof(row->hacker_state.display_buffer));
-  
-#if ANIMATION_STYLE == ANIMATION_STYLE_HACKER
-  GRect frame = layer_get_frame(text_layer_get_layer(row->label));
-  frame.origin.x = row->still_pos;
-  layer_set_frame(text_layer_get_layer(row->label), frame);
-#endif
+  animation_engine_register_row(row);
+}
 
-  data->last_hour = -1;
-  data->last_minute = -1;
-  data->last_day = -1;
-  data->last_battery = -1;
-  data->last_temperature = 999;
-  data->last_steps = -1;
-  data->last_step_update_minute = -1;
-  data->weather_changed = false;
+#if FEATURE_WEATHER_ICONS
+static void weather_icon_update_proc(Layer *layer, GContext *ctx) {
+  (void) layer;
+  if (s_data->icon.image) gdraw_command_image_draw(ctx, s_data->icon.image, GPointZero);
 }
 
-static void slide_in_text(SlidingTextData *data, SlidingRow *row, char* new_text, bool force_animate) {
-#if ANIMATION_STYLE == ANIMATION_STYLE_HACKER
-  // Skip animation during night mode (midnight to 6am) to conserve battery
-  if (is_night_mode()) {
-    text_layer_set_text(row->label, new_text);
-    row->hacker_state.animating = false;
-    strncpy(row->hacker_state.target_text, new_text, 63);
-    row->hacker_state.target_text[63] = '\0';
-    return;
+// Only a new icon id, or the condition being placed again, reads the resource
+static void load_weather_icon(SlidingTextData *data) {
+  if (data->icon.image) gdraw_command_image_destroy(data->icon.image);
+  data->icon.image = NULL;
+  if (!data->icon.layer) return;
+  if (data->icon.id >= 0 && data->icon.id < WEATHER_ICON_COUNT) {
+    data->icon.image = gdraw_command_image_create_with_resource(s_weather_icon_resources[data->icon.id]);
   }
-  start_hacker_animation(row, new_text, false, force_animate);
-  make_animation();
-#else
-  (void) data;
-  const char *old_text = text_layer_get_text(row->label);
-  if (old_text) {
-    row->next_string = new_text;
-    row->state = PREPARE_TO_MOVE;
+  layer_mark_dirty(data->icon.layer);
+}
+
+// The icon takes the outer end of the slot; returns what is left for the text
+static GRect create_weather_icon(SlidingTextData *data, Slot slot, GRect frame) {
+  GRect icon_frame = GRect(frame.origin.x, frame.origin.y + 4, WEATHER_ICON_SIZE, WEATHER_ICON_SIZE);
+  if (SLOT_IS_RIGHT(slot)) {
+    icon_frame.origin.x = frame.origin.x + frame.size.w - WEATHER_ICON_SIZE;
   } else {
-    text_layer_set_text(row->label, new_text);
-    GRect frame = layer_get_frame(text_layer_get_layer(row->label));
-    frame.origin.x = row->right_pos;
-    layer_set_frame(text_layer_get_layer(row->label), frame);
-    row->state = MOVING_IN;
+    frame.origin.x += WEATHER_ICON_SIZE + WEATHER_ICON_GAP;
   }
-#endif
+  frame.size.w -= WEATHER_ICON_SIZE + WEATHER_ICON_GAP;
+
+  data->icon.layer = layer_create(icon_frame);
+  layer_set_update_proc(data->icon.layer, weather_icon_update_proc);
+  layer_add_child(window_get_root_layer(data->window), data->icon.layer);
+  load_weather_icon(data);
+  return frame;
 }
 
-static bool update_sliding_row(SlidingTextData *data, SlidingRow *row) {
-#if ANIMATION_STYLE == ANIMATION_STYLE_HACKER
-  (void) data;
-  return update_hacker_animation(row);
-#else
-  GRect frame = layer_get_frame(text_layer_get_layer(row->label));
-  bool changed = true;
-  switch (row->state) {
-    case PREPARE_TO_MOVE:
-      frame.origin.x = row->still_pos;
-      row->delay_count++;
-      if (row->delay_count > row->movement_delay) {
-        row->state = MOVING_OUT;
-        row->delay_count = 0;
-      }
-      break;
-    case MOVING_IN: {
-      int speed = abs(frame.origin.x - row->still_pos) / 3 + 1;
-      frame.origin.x -= speed;
-      if (frame.origin.x <= row->still_pos) {
-        frame.origin.x = row->still_pos;
-        row->state = IN_FRAME;
-      }
-    }
-    break;
-    case MOVING_OUT: {
-      int speed = abs(frame.origin.x - row->still_pos) / 3 + 1;
-      frame.origin.x -= speed;
-      if (frame.origin.x <= row->left_pos) {
-        frame.origin.x = row->right_pos;
-        row->state = MOVING_IN;
-        text_layer_set_text(row->label, row->next_string);
-        row->next_string = NULL;
-      }
-    }
-    break;
-    default:
-      changed = false;
-      break;
+static void destroy_weather_icon(SlidingTextData *data) {
+  if (!data->icon.layer) return;
+  layer_remove_from_parent(data->icon.layer);
+  layer_destroy(data->icon.layer);
+  data->icon.layer = NULL;
+  load_weather_icon(data);
+}
+
+static void set_weather_icon(SlidingTextData *data, int id) {
+  if (id == data->icon.id) return;
+  data->icon.id = id;
+  TRACE(TRACE_EVENT_PERSIST_WRITE, PERSIST_WEATHER_ICON);
+  persist_write_int(PERSIST_WEATHER_ICON, id);
+  load_weather_icon(data);
+}
+#endif
+
+static void create_complication(SlidingTextData *data, Complication complication, Slot slot) {
+  ComplicationRow *row = (ComplicationRow*)malloc(sizeof(ComplicationRow));
+  if (!row) return;
+  memset(row->text, 0, sizeof(row->text));
+  row->next = 0;
+
+  const ComplicationSpec *spec = &s_complication_specs[complication];
+  Layer *window_layer = window_get_root_layer(data->window);
+  const int16_t width = layer_get_bounds(window_layer).size.w;
+  GRect frame = layout_slot_frame(slot, width, spec->wide);
+#if FEATURE_WEATHER_ICONS
+  if (complication == COMPLICATION_CONDITION) frame = create_weather_icon(data, slot, frame);
+#endif
+  init_sliding_row(&row->row, frame, spec->bold ? data->gothic18_bold : data->gothic18, 6);
+  if (SLOT_IS_RIGHT(slot)) {
+    text_layer_set_text_alignment(row->row.label, PBL_IF_ROUND_ELSE(GTextAlignmentCenter, GTextAlignmentRight));
+  } else {
+    text_layer_set_text_alignment(row->row.label, GTextAlignmentLeft);
+    text_layer_set_overflow_mode(row->row.label, GTextOverflowModeTrailingEllipsis);
   }
-  if (changed) layer_set_frame(text_layer_get_layer(row->label), frame);
-  return changed;
+  layer_add_child(window_layer, text_layer_get_layer(row->row.label));
+  data->complications[complication] = row;
+}
+
+static void destroy_complication(SlidingTextData *data, Complication complication) {
+  ComplicationRow *row = data->complications[complication];
+  if (!row) return;
+#if FEATURE_WEATHER_ICONS
+  if (complication == COMPLICATION_CONDITION) destroy_weather_icon(data);
 #endif
+  animation_engine_unregister_row(&row->row);
+  layer_remove_from_parent(text_layer_get_layer(row->row.label));
+  text_layer_destroy(row->row.label);
+  free(row);
+  data->complications[complication] = NULL;
 }
 
-#if ANIMATION_STYLE == ANIMATION_STYLE_HACKER
-static void hacker_animation_timer(void *data) {
-  SlidingTextData *app_data = (SlidingTextData *)data;
-  bool any_animating = false;
-  any_animating |= update_sliding_row(app_data, &app_data->day_row);
-  any_animating |= update_sliding_row(app_data, &app_data->hour_row);
-  any_animating |= update_sliding_row(app_data, &app_data->first_minute_row);
-  any_animating |= update_sliding_row(app_data, &app_data->second_minute_row);
-  any_animating |= update_sliding_row(app_data, &app_data->date_row);
-  any_animating |= update_sliding_row(app_data, &app_data->battery_row);
-  any_animating |= update_sliding_row(app_data, &app_data->weather_row);
-  any_animating |= update_sliding_row(app_data, &app_data->weather_condition_row);
-  any_animating |= update_sliding_row(app_data, &app_data->steps_row);
-  
-  if (any_animating) {
-    app_data->hacker_timer = app_timer_register(HACKER_ANIMATION_SPEED_MS, hacker_animation_timer, app_data);
-  } else {
-    app_data->hacker_timer = NULL;
+#if TRACE_ENABLED
+// Time rows first, then complications in registry order; matches tools/trace_to_chrome.py
+static int row_trace_id(SlidingTextData *data, SlidingRow *row) {
+  if (row == &data->hour_row) return 0;
+  if (row == &data->first_minute_row) return 1;
+  if (row == &data->second_minute_row) return 2;
+  for (int i = 0; i < COMPLICATION_COUNT; i++) {
+    if (data->complications[i] && row == &data->complications[i]->row) return 3 + i;
   }
+  return -1;
 }
 #endif
 
+static void slide_in_text(SlidingTextData *data, SlidingRow *row, char* new_text, bool force_animate) {
+  TRACE(TRACE_EVENT_SLIDE_IN, row_trace_id(data, row));
+  // Skip animation during night mode (midnight to 6am) to conserve battery
+  if (is_night_mode()) {
+    animation_engine_show_text(row, new_text);
+    return;
+  }
+  animation_engine_animate_text(row, new_text, false, force_animate);
+  make_animation();
+}
+
 static void make_animation() {
-#if ANIMATION_STYLE == ANIMATION_STYLE_HACKER
   if (!s_data->window_ready) return;
-  // Skip animation timer during night mode to conserve battery
+  // Skip animation frames during night mode to conserve battery
   if (is_night_mode()) return;
-  if (s_data->hacker_timer) app_timer_cancel(s_data->hacker_timer);
-  s_data->hacker_timer = app_timer_register(10, hacker_animation_timer, s_data);
-#endif
+  animation_engine_run();
 }
 
+// Into the spare minute slots; "oh five" rather than "five" for the first ten minutes
+static void format_minutes(SlidingTextData *data, int minute) {
+  char *first = data->render_state.first_minutes[data->render_state.next_minutes];
+  char *second = data->render_state.second_minutes[data->render_state.next_minutes];
+  minute_to_formal_words(minute, first, second);
+  if (minute > 0 && minute < 10) {
+    strcpy(second, first);
+    strcpy(first, "oh");
+  }
+}
 
+// Rows start 2 px in and span the display; anything wider wraps into the row below
+static bool fits_row(SlidingTextData *data, SlidingRow *row, const char *text) {
+  return glyph_atlas_text_width(row->atlas, text) <= get_screen_width(data) - 2;
+}
 
-static void update_time_display(void) {
-  SlidingTextData *data = s_data;
-  time_t now = time(NULL);
-  struct tm t = *localtime(&now);
+// Into the spare slots of all three rows, a word to a row: "quarter" / "to" / "three".
+// "twenty five after ten" has a word too many, so the narrowest neighbouring pair
+// shares a row. When a row still doesn't fit, the rounded time is shown the way
+// the face shows exact time: "ten" / "twenty" / "five"
+static void format_fuzzy(SlidingTextData *data, int hour, int minute) {
+  char phrase[64];
+  fuzzy_time_to_words(hour, minute, phrase);
+  char *words[4];
+  int count = 0;
+  for (char *c = phrase; *c && count < 4; ) {
+    words[count++] = c;
+    while (*c && *c != ' ') c++;
+    if (*c) *c++ = '\0';
+  }
 
-  if (data->last_day != t.tm_wday || data->weather_changed) {
-    // Generate the full day and date names
-    char full_day[32];
-    day_to_word(t.tm_wday, full_day);
-    
-    char full_date[32];
-    day_of_month_to_words(t.tm_mday, full_date);
-    
-    // Get current left-side text for collision checks
-    const char *temp_text = text_layer_get_text(data->weather_condition_row.label);
-    const char *cond_text = text_layer_get_text(data->weather_row.label);
-    
-    // Evaluate line 1 collision: temperature (left) vs day (right)
-    if (temp_text) {
-      if (check_line1_collision(data, temp_text, full_day)) {
-        // Collision: use abbreviated day
-        strcpy(data->render_state.days[data->render_state.next_days], temp_text);
-        day_to_short(t.tm_wday, data->render_state.days[data->render_state.next_days]);
-        data->collapse_state.day_collapsed = true;
-      } else {
-        // No collision: use full day
-        strcpy(data->render_state.days[data->render_state.next_days], full_day);
-        data->collapse_state.day_collapsed = false;
-      }
-    } else {
-      strcpy(data->render_state.days[data->render_state.next_days], full_day);
-      data->collapse_state.day_collapsed = false;
+  SlidingRow *rows[3] = { &data->hour_row, &data->first_minute_row, &data->second_minute_row };
+  char *texts[3] = {
+    data->render_state.hours[data->render_state.next_hours],
+    data->render_state.first_minutes[data->render_state.next_minutes],
+    data->render_state.second_minutes[data->render_state.next_minutes]
+  };
+  const size_t size = sizeof(data->render_state.hours[0]);
+  int joined = -1;
+  int narrowest = 0;
+  for (int i = 0; count > 3 && i < 3; i++) {
+    snprintf(texts[i], size, "%s %s", words[i], words[i + 1]);
+    int width = glyph_atlas_text_width(rows[i]->atlas, texts[i]);
+    if (joined < 0 || width < narrowest) {
+      joined = i;
+      narrowest = width;
     }
-    
-    // Evaluate line 2 collision: weather condition (left) vs date (right)
-    if (cond_text) {
-      if (check_line2_collision(data, cond_text, full_date)) {
-        // Collision: use numeric date
-        date_to_short(t.tm_mday, data->render_state.dates[data->render_state.next_dates]);
-        data->collapse_state.date_collapsed = true;
-      } else {
-        // No collision: use full date
-        strcpy(data->render_state.dates[data->render_state.next_dates], full_date);
-        data->collapse_state.date_collapsed = false;
-      }
+  }
+
+  bool fits = true;
+  for (int row = 0, word = 0; row < 3; row++) {
+    if (word >= count) {
+      texts[row][0] = '\0';
+    } else if (row == joined) {
+      snprintf(texts[row], size, "%s %s", words[word], words[word + 1]);
+      word += 2;
     } else {
-      strcpy(data->render_state.dates[data->render_state.next_dates], full_date);
-      data->collapse_state.date_collapsed = false;
+      snprintf(texts[row], size, "%s", words[word++]);
     }
-    
-    if (data->last_day != t.tm_wday) {
-      slide_in_text(data, &data->day_row, data->render_state.days[data->render_state.next_days], false);
-      slide_in_text(data, &data->date_row, data->render_state.dates[data->render_state.next_dates], false);
-      data->render_state.next_days = data->render_state.next_days ? 0 : 1;
-      data->render_state.next_dates = data->render_state.next_dates ? 0 : 1;
-      data->last_day = t.tm_wday;
-    }
-    if (data->weather_changed) {
-      data->weather_changed = false;
+    fits = fits && fits_row(data, rows[row], texts[row]);
+  }
+  if (fits) return;
+
+  int rounded = (hour * 60 + minute + FUZZY_LEAD_MINUTES) / FUZZY_STEP_MINUTES * FUZZY_STEP_MINUTES % (24 * 60);
+  hour_to_12h_word(rounded / 60, texts[0]);
+  format_minutes(data, rounded % 60);
+}
+
+// Start of the minute the rounded time next changes in
+static time_t next_fuzzy_change(time_t now) {
+  struct tm t = *localtime(&now);
+  int since_change = (t.tm_min + FUZZY_LEAD_MINUTES) % FUZZY_STEP_MINUTES * 60 + t.tm_sec;
+  return now - since_change + FUZZY_STEP_MINUTES * 60;
+}
+
+// The idle handler: once an animation settles, fill the spare slots for the
+// coming minute, so its tick only swaps them in and starts animating. With
+// fuzzy time the coming minute is the next change of the rounded time
+static void prepare_next_minute(void) {
+  SlidingTextData *data = s_data;
+  time_t now = time(NULL);
+  time_t next = data->fuzzy.enabled ? next_fuzzy_change(now) : now - now % 60 + 60;
+  if (data->render_state.prepared_minute == next) return;
+  struct tm t = *localtime(&next);
+  TRACE(TRACE_EVENT_PRECOMPUTE, t.tm_min);
+
+  data->render_state.prepared_lines = 0;
+  data->render_state.prepared_complications = 0;
+  if (data->fuzzy.enabled) {
+    // The day and date lines change on their own timer, see schedule_day_change()
+    format_fuzzy(data, t.tm_hour, t.tm_min);
+    data->render_state.prepared_minute = next;
+    return;
+  }
+
+  format_minutes(data, t.tm_min);
+  data->render_state.hours_prepared = t.tm_hour != data->last_hour;
+  if (data->render_state.hours_prepared) {
+    hour_to_12h_word(t.tm_hour, data->render_state.hours[data->render_state.next_hours]);
+  }
+
+  if (t.tm_wday != data->last_day) {
+    data->day_time = next;
+    for (int line = 0; line < LAYOUT_LINE_COUNT; line++) {
+      if (line_shows_day(data, line)) prepare_line(data, line);
     }
+    data->day_time = 0;
+  }
+  data->render_state.prepared_minute = next;
+}
+
+// Only animate if text actually changed; the engine scrambles just the differing characters
+static void slide_in_changed_text(SlidingTextData *data, SlidingRow *row, char *new_text) {
+  const char *current = text_layer_get_text(row->label);
+  if (!current || strcmp(current, new_text) != 0) slide_in_text(data, row, new_text, false);
+}
+
+static void update_day_display(SlidingTextData *data, const struct tm *t, bool prepared) {
+  if (data->last_day == t->tm_wday) return;
+  data->last_day = t->tm_wday;
+  for (int line = 0; line < LAYOUT_LINE_COUNT; line++) {
+    if (!line_shows_day(data, line)) continue;
+    if (prepared && (data->render_state.prepared_lines & (1 << line))) commit_line(data, line);
+    else refresh_line(data, line);
+  }
+}
+
+static void update_time_display(void) {
+  SlidingTextData *data = s_data;
+  time_t now = time(NULL);
+  struct tm t = *localtime(&now);
+  // Without an animation since the last tick nothing was prepared, so this tick formats
+  bool prepared = data->render_state.prepared_minute == now - now % 60;
+  data->render_state.prepared_minute = 0;
+
+  update_day_display(data, &t, prepared);
+
+  // Fuzzy time spreads one phrase over all three rows, whichever of them changed
+  if (data->fuzzy.enabled) {
+    if (!prepared) format_fuzzy(data, t.tm_hour, t.tm_min);
+    slide_in_changed_text(data, &data->hour_row, data->render_state.hours[data->render_state.next_hours]);
+    slide_in_changed_text(data, &data->first_minute_row, data->render_state.first_minutes[data->render_state.next_minutes]);
+    slide_in_changed_text(data, &data->second_minute_row, data->render_state.second_minutes[data->render_state.next_minutes]);
+    data->render_state.next_hours = data->render_state.next_hours ? 0 : 1;
+    data->render_state.next_minutes = data->render_state.next_minutes ? 0 : 1;
+    data->last_hour = t.tm_hour;
+    data->last_minute = t.tm_min;
+    return;
   }
 
   if (data->last_minute != t.tm_min) {
-    minute_to_formal_words(t.tm_min, data->render_state.first_minutes[data->render_state.next_minutes], 
-                           data->render_state.second_minutes[data->render_state.next_minutes]);
-    
-    if (t.tm_min > 0 && t.tm_min < 10) {
-      strcpy(data->render_state.second_minutes[data->render_state.next_minutes], 
-             data->render_state.first_minutes[data->render_state.next_minutes]);
-      strcpy(data->render_state.first_minutes[data->render_state.next_minutes], "oh");
-    }
-    
-    // Only animate if text actually changed (force full animation for visibility)
-    const char *current_first = text_layer_get_text(data->first_minute_row.label);
-    const char *current_second = text_layer_get_text(data->second_minute_row.label);
-    
-    if (!current_first || strcmp(current_first, data->render_state.first_minutes[data->render_state.next_minutes]) != 0) {
-      slide_in_text(data, &data->first_minute_row, data->render_state.first_minutes[data->render_state.next_minutes], true);
-    }
-    if (!current_second || strcmp(current_second, data->render_state.second_minutes[data->render_state.next_minutes]) != 0) {
-      slide_in_text(data, &data->second_minute_row, data->render_state.second_minutes[data->render_state.next_minutes], true);
-    }
-    
+    if (!prepared) format_minutes(data, t.tm_min);
+    slide_in_changed_text(data, &data->first_minute_row, data->render_state.first_minutes[data->render_state.next_minutes]);
+    slide_in_changed_text(data, &data->second_minute_row, data->render_state.second_minutes[data->render_state.next_minutes]);
     data->render_state.next_minutes = data->render_state.next_minutes ? 0 : 1;
     data->last_minute = t.tm_min;
   }
 
   if (data->last_hour != t.tm_hour) {
-    hour_to_12h_word(t.tm_hour, data->render_state.hours[data->render_state.next_hours]);
-    slide_in_text(data, &data->hour_row, data->render_state.hours[data->render_state.next_hours], false);
+    if (!prepared || !data->render_state.hours_prepared) {
+      hour_to_12h_word(t.tm_hour, data->render_state.hours[data->render_state.next_hours]);
+    }
+    // Leaving fuzzy time can leave the hour's word already showing
+    slide_in_changed_text(data, &data->hour_row, data->render_state.hours[data->render_state.next_hours]);
     data->render_state.next_hours = data->render_state.next_hours ? 0 : 1;
     data->last_hour = t.tm_hour;
   }
 }
 
+// ============================================================================
+// SUNRISE / SUNSET
+// ============================================================================
+
+// last_sun_event encodes what the sun row shows: sunrise minutes, SUN_EVENT_SUNSET
+// plus sunset minutes, or one of the polar states
+#define SUN_EVENT_SUNSET (24 * 60)
+#define SUN_EVENT_POLAR_DAY (2 * 24 * 60)
+#define SUN_EVENT_POLAR_NIGHT (2 * 24 * 60 + 1)
+
+// "sunset six forty", "sunrise seven oh five", "sunset eight"; "sunset 6:40" as digits
+static void sun_event_to_text(int event, bool digits, char *buffer, size_t size) {
+  if (event == SUN_EVENT_POLAR_DAY) {
+    snprintf(buffer, size, "midnight sun");
+    return;
+  }
+  if (event == SUN_EVENT_POLAR_NIGHT) {
+    snprintf(buffer, size, "polar night");
+    return;
+  }
+
+  bool sunset = event >= SUN_EVENT_SUNSET;
+  const char *name = sunset ? "sunset" : "sunrise";
+  int minutes = sunset ? event - SUN_EVENT_SUNSET : event;
+  int minute = minutes % 60;
+  if (digits) {
+    snprintf(buffer, size, "%s %d:%02d", name, (minutes / 60) % 12 ? (minutes / 60) % 12 : 12, minute);
+    return;
+  }
+
+  char hour_word[16], minute_words[64];
+  hour_to_12h_word(minutes / 60, hour_word);
+  number_to_words(minute, minute_words);
+  if (minute == 0) snprintf(buffer, size, "%s %s", name, hour_word);
+  else if (minute < 10) snprintf(buffer, size, "%s %s oh %s", name, hour_word, minute_words);
+  else snprintf(buffer, size, "%s %s %s", name, hour_word, minute_words);
+}
+
+// Work out the upcoming sun event; returns true if it changed
+static bool update_sun_event(SlidingTextData *data) {
+  if (!complication_enabled(data, COMPLICATION_SUN) || !sun_times_has_location()) return false;
+
+  time_t now = time(NULL);
+  struct tm t = *localtime(&now);
+  const SunTimes *sun = sun_times_for(now);
+  int minute_of_day = t.tm_hour * 60 + t.tm_min;
+
+  int event;
+  if (sun->sunrise == SUN_TIME_NONE || sun->sunset == SUN_TIME_NONE) {
+    event = sun->polar_day ? SUN_EVENT_POLAR_DAY : SUN_EVENT_POLAR_NIGHT;
+  } else {
+    // Whichever comes first from now; tomorrow's sunrise is close enough to today's
+    int until_sunrise = (sun->sunrise - minute_of_day + 24 * 60 - 1) % (24 * 60);
+    int until_sunset = (sun->sunset - minute_of_day + 24 * 60 - 1) % (24 * 60);
+    event = until_sunrise < until_sunset ? sun->sunrise : SUN_EVENT_SUNSET + sun->sunset;
+  }
+  if (event == data->last_sun_event) return false;
+  data->last_sun_event = event;
+  return true;
+}
+
+static void update_sun_display(SlidingTextData *data) {
+  if (update_sun_event(data)) refresh_complication(data, COMPLICATION_SUN);
+}
+
+// ============================================================================
+// SERVICES
+// ============================================================================
+
+// Readings that fail their policy never reach the animation or a persist write
+static bool significant(Complication complication, SignificanceFilter *filter, const SignificancePolicy *policy,
+                        int shown, int value, bool urgent) {
+  if (significance_accept(filter, policy, shown, value, urgent, time(NULL))) return true;
+  if (value != shown) {
+    TRACE(TRACE_EVENT_FILTERED, complication);
+  }
+  return false;
+}
+
 static void handle_minute_tick(struct tm *tick_time, TimeUnits units_changed) {
   (void) units_changed;
+  TRACE(TRACE_EVENT_TICK, tick_time->tm_min);
+  // Fuzzy time ticks every five minutes, so look for hours and half hours passed
+  // since the last tick rather than landed on
+  int minute_of_day = tick_time->tm_hour * 60 + tick_time->tm_min;
+  bool new_hour = minute_of_day / 60 != s_data->last_tick_minute / 60;
+  bool new_half_hour = minute_of_day / 30 != s_data->last_tick_minute / 30;
+  s_data->last_tick_minute = minute_of_day;
+
   update_time_display();
-  if (tick_time->tm_min % 30 == 0) request_weather();
+  update_sun_display(s_data);
+#if FEATURE_HEART_RATE
+  if (s_data->heart_rate_subscribed && s_data->heart_rate.active) update_heart_rate_cadence(s_data);
+#endif
+  // The time left counts down between battery events, in hours at the finest
+  if (new_hour && s_data->battery_time_left) refresh_complication(s_data, COMPLICATION_BATTERY);
+  if (new_half_hour) request_weather();
 }
 
 static void handle_battery(BatteryChargeState charge_state) {
   SlidingTextData *data = s_data;
   int battery_percent = charge_state.charge_percent;
-  
-  if (data->last_battery != battery_percent) {
-    char full_battery[64];
-    char num_words[64];
-    number_to_words(battery_percent, num_words);
-    snprintf(full_battery, 64, "%s pc", num_words);
-    
-    const char *steps_text = text_layer_get_text(data->steps_row.label);
-    
-    // Evaluate line 6 collision: steps (left, gothic18_bold) vs battery (right, gothic18)
-    if (steps_text) {
-      if (check_line6_collision(data, steps_text, full_battery)) {
-        // Collision: use numeric battery
-        battery_to_short(battery_percent, data->render_state.battery[data->render_state.next_battery]);
-        data->collapse_state.battery_collapsed = true;
-      } else {
-        // No collision: use full battery
-        strcpy(data->render_state.battery[data->render_state.next_battery], full_battery);
-        data->collapse_state.battery_collapsed = false;
-      }
-    } else {
-      strcpy(data->render_state.battery[data->render_state.next_battery], full_battery);
-      data->collapse_state.battery_collapsed = false;
-    }
-    
-    slide_in_text(data, &data->battery_row, data->render_state.battery[data->render_state.next_battery], false);
-    data->render_state.next_battery = data->render_state.next_battery ? 0 : 1;
-    data->last_battery = battery_percent;
-    make_animation();
-  } else {
-    // Even if battery percent hasn't changed, check if currently collapsed text can be expanded
-    // This handles the case where steps text changed, allowing battery to expand
-    const char *steps_text = text_layer_get_text(data->steps_row.label);
-    if (steps_text && data->last_battery >= 0) {
-      handle_line6_update(data, steps_text, data->last_battery);
-    }
+  TRACE(TRACE_EVENT_BATTERY, battery_percent);
+  battery_history_record(charge_state, time(NULL));
+  if (!data->battery_shown) return;
+  bool urgent = data->last_battery < 0 || battery_percent < BATTERY_LOW_PERCENT ||
+                charge_state.is_charging || charge_state.is_plugged;
+  if (!significant(COMPLICATION_BATTERY, &data->battery_filter, &s_battery_policy,
+                   data->last_battery, battery_percent, urgent)) return;
+
+  data->last_battery = battery_percent;
+  refresh_complication(data, COMPLICATION_BATTERY);
+  make_animation();
+}
+
+#if FEATURE_HEALTH
+static void show_steps(SlidingTextData *data, int steps) {
+  if (!complication_enabled(data, COMPLICATION_STEPS)) return;
+  if (!significant(COMPLICATION_STEPS, &data->steps_filter, &s_steps_policy,
+                   data->last_steps, steps, data->last_steps < 0)) return;
+
+  data->last_steps = steps;
+  refresh_complication(data, COMPLICATION_STEPS);
+  make_animation();
+}
+#endif
+
+#if FEATURE_HEART_RATE
+// The HRM samples every HEART_RATE_ACTIVE_PERIOD_S while the wearer walks
+// briskly, and at the system default (about every ten minutes) otherwise and
+// whenever something covers the face
+#define HEART_RATE_ACTIVE_PERIOD_S 60
+#define HEART_RATE_ACTIVE_CADENCE 60     // steps a minute to start sampling faster...
+#define HEART_RATE_IDLE_CADENCE 30       // ...and to stop again
+#define HEART_RATE_CADENCE_WINDOW_S 120
+// A requested period lapses after a while; renew it this long before
+#define HEART_RATE_RENEW_S (10 * 60)
+
+static bool heart_rate_available(void) {
+  time_t now = time(NULL);
+  return health_service_metric_accessible(HealthMetricHeartRateBPM, now, now) & HealthServiceAccessibilityMaskAvailable;
+}
+
+static void apply_heart_rate_period(SlidingTextData *data) {
+  uint16_t period = data->heart_rate.active && data->heart_rate.in_focus ? HEART_RATE_ACTIVE_PERIOD_S : 0;
+  bool renew = period && health_service_get_heart_rate_sample_period_expiration_sec() < HEART_RATE_RENEW_S;
+  if (period == data->heart_rate.period_s && !renew) return;
+  data->heart_rate.period_s = period;
+  health_service_set_heart_rate_sample_period(period);
+}
+
+// Steps a minute over the window that just ended decide the sample period.
+// Movement updates stop when the wearer does, so the minute tick closes
+// windows too, with whatever total came in last
+static void update_heart_rate_cadence(SlidingTextData *data) {
+  time_t now = time(NULL);
+  time_t elapsed = now - data->heart_rate.window_start;
+  if (data->heart_rate.latest_steps < data->heart_rate.window_steps) {
+    // The daily total restarted at midnight
+    data->heart_rate.window_steps = data->heart_rate.latest_steps;
+    data->heart_rate.window_start = now;
+    return;
+  }
+  if (elapsed < HEART_RATE_CADENCE_WINDOW_S) return;
+
+  int cadence = (int)((data->heart_rate.latest_steps - data->heart_rate.window_steps) * 60 / elapsed);
+  data->heart_rate.active = cadence >= (data->heart_rate.active ? HEART_RATE_IDLE_CADENCE : HEART_RATE_ACTIVE_CADENCE);
+  data->heart_rate.window_steps = data->heart_rate.latest_steps;
+  data->heart_rate.window_start = now;
+  apply_heart_rate_period(data);
+}
+
+static void show_heart_rate(SlidingTextData *data) {
+  if (!heart_rate_available()) return;
+  int bpm = (int)health_service_peek_current_value(HealthMetricHeartRateBPM);
+  if (bpm <= 0) return;
+  if (!significant(COMPLICATION_HEART_RATE, &data->heart_rate.filter, &s_heart_rate_policy,
+                   data->heart_rate.bpm, bpm, data->heart_rate.bpm < 0)) return;
+
+  data->heart_rate.bpm = bpm;
+  refresh_complication(data, COMPLICATION_HEART_RATE);
+  make_animation();
+}
+
+// Notifications and other modals cover the face; nobody sees the row then
+static void app_focus_handler(bool in_focus) {
+  s_data->heart_rate.in_focus = in_focus;
+  apply_heart_rate_period(s_data);
+}
+
+static void heart_rate_subscribe(SlidingTextData *data) {
+  data->heart_rate.bpm = -1;
+  significance_reset(&data->heart_rate.filter);
+  data->heart_rate.active = false;
+  data->heart_rate.in_focus = true;
+  data->heart_rate.period_s = 0;
+  time_t now = time(NULL);
+  data->heart_rate.window_start = now;
+  data->heart_rate.latest_steps = 0;
+  if (health_service_metric_accessible(HealthMetricStepCount, time_start_of_today(), now) & HealthServiceAccessibilityMaskAvailable) {
+    data->heart_rate.latest_steps = (int32_t)health_service_sum_today(HealthMetricStepCount);
   }
+  data->heart_rate.window_steps = data->heart_rate.latest_steps;
+  app_focus_service_subscribe(app_focus_handler);
+  show_heart_rate(data);
 }
 
+// Hand the HRM back to the system default
+static void heart_rate_unsubscribe(SlidingTextData *data) {
+  app_focus_service_unsubscribe();
+  data->heart_rate.active = false;
+  apply_heart_rate_period(data);
+}
+#endif
+
+#if FEATURE_HEALTH
 static void health_handler(HealthEventType event, void *context) {
   (void) context;
+  TRACE(TRACE_EVENT_HEALTH, event);
+#if FEATURE_HEART_RATE
+  if (event == HealthEventHeartRateUpdate) {
+    if (s_data->heart_rate_subscribed) show_heart_rate(s_data);
+    return;
+  }
+#endif
   if (event != HealthEventMovementUpdate) return;
-  
-  SlidingTextData *data = s_data;
+
   HealthMetric metric = HealthMetricStepCount;
   time_t start = time_start_of_today();
   time_t end = time(NULL);
-  
+
   if (!(health_service_metric_accessible(metric, start, end) & HealthServiceAccessibilityMaskAvailable)) return;
-  
+
   int steps = (int)health_service_sum_today(metric);
+#if FEATURE_HEART_RATE
+  if (s_data->heart_rate_subscribed) {
+    s_data->heart_rate.latest_steps = steps;
+    update_heart_rate_cadence(s_data);
+  }
+#endif
+  // With the worker counting, its messages show steps instead
+  if (!s_data->steps_from_worker) show_steps(s_data, steps);
+}
+
+static void worker_message_handler(uint16_t type, AppWorkerMessage *message) {
+  if (type != WORKER_MESSAGE_STEPS) return;
+  TRACE(TRACE_EVENT_HEALTH, HealthEventMovementUpdate);
+  show_steps(s_data, (int)((uint32_t)message->data0 | ((uint32_t)message->data1 << 16)));
+}
+
+static void steps_subscribe(SlidingTextData *data) {
+  data->last_steps = -1;
+  significance_reset(&data->steps_filter);
+  // The background worker tracks steps all day; with it running, its last
+  // snapshot shows instantly and its messages replace our own health subscription
+  data->steps_from_worker = app_worker_is_running() || app_worker_launch() == APP_WORKER_RESULT_SUCCESS;
+  if (data->steps_from_worker) {
+    app_worker_message_subscribe(worker_message_handler);
+    WorkerSnapshot snapshot;
+    if (persist_read_data(WORKER_PERSIST_SNAPSHOT, &snapshot, sizeof(snapshot)) == sizeof(snapshot) &&
+        snapshot.version == WORKER_SNAPSHOT_VERSION && snapshot.steps_day == (uint32_t)time_start_of_today()) {
+      show_steps(data, snapshot.steps);
+    }
+  } else {
+    health_handler(HealthEventMovementUpdate, NULL);
+  }
+}
+
+static void steps_unsubscribe(SlidingTextData *data) {
+  if (data->steps_from_worker) {
+    app_worker_message_unsubscribe();
+    app_worker_kill();
+  }
+  data->steps_from_worker = false;
+}
+#endif
+
+// Services follow the layout: nothing is subscribed for a complication that's off.
+// Battery is the exception, subscribed for the discharge history from init
+static void update_subscriptions(SlidingTextData *data) {
+  bool want_battery = complication_enabled(data, COMPLICATION_BATTERY);
+  if (want_battery != data->battery_shown) {
+    data->battery_shown = want_battery;
+    if (want_battery) {
+      data->last_battery = -1;
+      significance_reset(&data->battery_filter);
+      handle_battery(battery_state_service_peek());
+    }
+  }
+
+#if FEATURE_HEALTH
+  bool want_steps = complication_enabled(data, COMPLICATION_STEPS);
+  if (want_steps != data->steps_subscribed) {
+    data->steps_subscribed = want_steps;
+    if (want_steps) steps_subscribe(data);
+    else steps_unsubscribe(data);
+  }
+
+#if FEATURE_HEART_RATE
+  bool want_heart_rate = complication_enabled(data, COMPLICATION_HEART_RATE);
+  if (want_heart_rate != data->heart_rate_subscribed) {
+    data->heart_rate_subscribed = want_heart_rate;
+    if (want_heart_rate) heart_rate_subscribe(data);
+    else heart_rate_unsubscribe(data);
+  }
+#endif
+
+  bool want_health = (data->steps_subscribed && !data->steps_from_worker) || data->heart_rate_subscribed;
+  if (want_health != data->health_subscribed) {
+    data->health_subscribed = want_health;
+    if (want_health) health_service_events_subscribe(health_handler, NULL);
+    else health_service_events_unsubscribe();
+  }
+#endif
+}
+
+// The phone's weather message also carries the location for sunrise/sunset
+static bool wants_weather(SlidingTextData *data) {
+  return complication_enabled(data, COMPLICATION_WEATHER) || complication_enabled(data, COMPLICATION_CONDITION) ||
+         complication_enabled(data, COMPLICATION_SUN);
+}
+
+// Create a row for each placed complication, subscribe what they need and
+// fill every line; rows left over from a previous layout are destroyed first
+static void build_complications(SlidingTextData *data) {
+  for (int i = 0; i < COMPLICATION_COUNT; i++) {
+    destroy_complication(data, (Complication)i);
+    Slot slot = layout_slot_of(&data->layout, (Complication)i);
+    if (slot != SLOT_OFF) create_complication(data, (Complication)i, slot);
+  }
+
+  update_subscriptions(data);
+  data->last_sun_event = -1;
+  update_sun_event(data);
+  for (int line = 0; line < LAYOUT_LINE_COUNT; line++) {
+    refresh_line(data, line);
+  }
+}
+
+// ============================================================================
+// FUZZY TIME
+// ============================================================================
+
+// Instead of the minute tick, one timer for each change of the rounded time and
+// one for midnight, which falls between two changes
+static void schedule_fuzzy_change(SlidingTextData *data);
+static void schedule_day_change(SlidingTextData *data);
+
+static void fuzzy_timer_callback(void *context) {
+  (void) context;
+  SlidingTextData *data = s_data;
+  data->fuzzy.timer = NULL;
   time_t now = time(NULL);
   struct tm t = *localtime(&now);
-  
-  bool five_minutes_passed = (data->last_step_update_minute == -1) || 
-                              (abs(t.tm_min - data->last_step_update_minute) >= 5) ||
-                              (data->last_step_update_minute > t.tm_min && (60 - data->last_step_update_minute + t.tm_min) >= 5);
-  
-  if (data->last_steps != steps && five_minutes_passed) {
-    steps_to_significant_figure(steps, data->render_state.steps[data->render_state.next_steps]);
-    slide_in_text(data, &data->steps_row, data->render_state.steps[data->render_state.next_steps], false);
-    data->render_state.next_steps = data->render_state.next_steps ? 0 : 1;
-    data->last_steps = steps;
-    data->last_step_update_minute = t.tm_min;
-    
-    // After steps update, check if battery needs to collapse/uncollapse
-    const char *new_steps_text = text_layer_get_text(data->steps_row.label);
-    if (new_steps_text && data->last_battery >= 0) {
-      handle_line6_update(data, new_steps_text, data->last_battery);
+  handle_minute_tick(&t, MINUTE_UNIT);
+  schedule_fuzzy_change(data);
+}
+
+static void day_timer_callback(void *context) {
+  (void) context;
+  SlidingTextData *data = s_data;
+  data->fuzzy.day_timer = NULL;
+  time_t now = time(NULL);
+  struct tm t = *localtime(&now);
+  update_day_display(data, &t, false);
+  make_animation();
+  schedule_day_change(data);
+}
+
+static void schedule_fuzzy_change(SlidingTextData *data) {
+  time_t now;
+  uint16_t millis;
+  time_ms(&now, &millis);
+  uint32_t delay_ms = (uint32_t)(next_fuzzy_change(now) - now) * 1000 - millis;
+  data->fuzzy.timer = app_timer_register(delay_ms, fuzzy_timer_callback, NULL);
+}
+
+static void schedule_day_change(SlidingTextData *data) {
+  time_t now;
+  uint16_t millis;
+  time_ms(&now, &millis);
+  // mktime() normalises the day after, across month ends and DST changes
+  struct tm midnight = *localtime(&now);
+  midnight.tm_mday++;
+  midnight.tm_hour = midnight.tm_min = midnight.tm_sec = 0;
+  midnight.tm_isdst = -1;
+  uint32_t delay_ms = (uint32_t)(mktime(&midnight) - now) * 1000 - millis;
+  data->fuzzy.day_timer = app_timer_register(delay_ms, day_timer_callback, NULL);
+}
+
+static void subscribe_minute_tick(SlidingTextData *data) {
+  if (data->fuzzy.enabled) tick_timer_service_unsubscribe();
+  else tick_timer_service_subscribe(MINUTE_UNIT, handle_minute_tick);
+}
+
+static void set_fuzzy_time(SlidingTextData *data, bool enabled) {
+  if (enabled == data->fuzzy.enabled) return;
+  data->fuzzy.enabled = enabled;
+
+  if (enabled) {
+    schedule_fuzzy_change(data);
+    schedule_day_change(data);
+  } else {
+    app_timer_cancel(data->fuzzy.timer);
+    app_timer_cancel(data->fuzzy.day_timer);
+    data->fuzzy.timer = NULL;
+    data->fuzzy.day_timer = NULL;
+  }
+  bool seconds_showing = false;
+#if FEATURE_FLICK_SECONDS
+  // An open seconds window keeps its second tick and settles this when it closes
+  seconds_showing = data->flick.until != 0;
+#endif
+  if (!seconds_showing) subscribe_minute_tick(data);
+
+  // Redraw all three rows in the new style now rather than at the next change
+  data->render_state.prepared_minute = 0;
+  data->last_hour = -1;
+  data->last_minute = -1;
+  update_time_display();
+  make_animation();
+}
+
+#if FEATURE_FLICK_SECONDS
+// ============================================================================
+// SECONDS ON FLICK
+// ============================================================================
+
+// A flick shows seconds on the bottom line for this long; only then does the
+// face tick every second
+#define FLICK_SECONDS_WINDOW_S 10
+
+static void set_bottom_line_hidden(SlidingTextData *data, bool hidden) {
+  for (int i = 0; i < COMPLICATION_COUNT; i++) {
+    Slot slot = layout_slot_of(&data->layout, (Complication)i);
+    if (data->complications[i] && slot != SLOT_OFF && SLOT_LINE(slot) == LAYOUT_LINE_COUNT - 1) {
+      layer_set_hidden(text_layer_get_layer(data->complications[i]->row.label), hidden);
     }
-    
-    make_animation();
   }
 }
 
+static void show_seconds(SlidingTextData *data, int seconds) {
+  seconds_to_words(seconds, data->flick.text, sizeof(data->flick.text));
+  text_layer_set_text(data->flick.label, data->flick.text);
+}
+
+static void end_seconds_window(SlidingTextData *data) {
+  data->flick.until = 0;
+  layer_set_hidden(text_layer_get_layer(data->flick.label), true);
+  set_bottom_line_hidden(data, false);
+  subscribe_minute_tick(data);
+}
+
+static void handle_second_tick(struct tm *tick_time, TimeUnits units_changed) {
+  SlidingTextData *data = s_data;
+  // Fuzzy time's own timer keeps running under the second tick
+  if ((units_changed & MINUTE_UNIT) && !data->fuzzy.enabled) handle_minute_tick(tick_time, units_changed);
+  if (time(NULL) >= data->flick.until) {
+    end_seconds_window(data);
+    return;
+  }
+  show_seconds(data, tick_time->tm_sec);
+}
+
+static void accel_tap_handler(AccelAxisType axis, int32_t direction) {
+  (void) axis;
+  (void) direction;
+  SlidingTextData *data = s_data;
+  bool showing = data->flick.until != 0;
+  data->flick.until = time(NULL) + FLICK_SECONDS_WINDOW_S;
+  // Another flick while showing just keeps the seconds up longer
+  if (showing) return;
+
+  time_t now = time(NULL);
+  struct tm t = *localtime(&now);
+  show_seconds(data, t.tm_sec);
+  set_bottom_line_hidden(data, true);
+  layer_set_hidden(text_layer_get_layer(data->flick.label), false);
+  tick_timer_service_subscribe(SECOND_UNIT, handle_second_tick);
+}
+
+static void set_flick_seconds(SlidingTextData *data, bool enabled) {
+  if (enabled == data->flick.enabled) return;
+  data->flick.enabled = enabled;
+
+  if (enabled) {
+    Layer *window_layer = window_get_root_layer(data->window);
+    const int16_t width = layer_get_bounds(window_layer).size.w;
+    data->flick.label = text_layer_create(layout_slot_frame(SLOT_LEFT(LAYOUT_LINE_COUNT - 1), width, true));
+    text_layer_set_text_alignment(data->flick.label, PBL_IF_ROUND_ELSE(GTextAlignmentCenter, GTextAlignmentLeft));
+    text_layer_set_background_color(data->flick.label, GColorClear);
+    text_layer_set_text_color(data->flick.label, GColorWhite);
+    text_layer_set_font(data->flick.label, data->gothic18_bold);
+    layer_set_hidden(text_layer_get_layer(data->flick.label), true);
+    layer_add_child(window_layer, text_layer_get_layer(data->flick.label));
+    accel_tap_service_subscribe(accel_tap_handler);
+  } else {
+    accel_tap_service_unsubscribe();
+    if (data->flick.until) end_seconds_window(data);
+    layer_remove_from_parent(text_layer_get_layer(data->flick.label));
+    text_layer_destroy(data->flick.label);
+    data->flick.label = NULL;
+  }
+}
+#endif
+
+// ============================================================================
+// APP MESSAGE
+// ============================================================================
+
+// Clay sends select values as strings and toggles as integers
+static int tuple_to_int(const Tuple *tuple) {
+  return tuple->type == TUPLE_CSTRING ? atoi(tuple->value->cstring) : (int)tuple->value->int32;
+}
+
 static void inbox_received_callback(DictionaryIterator *iterator, void *context) {
   (void) context;
   SlidingTextData *data = s_data;
-  
+  TRACE(TRACE_EVENT_INBOX, 0);
+
+  Tuple *trace_tuple = dict_find(iterator, MESSAGE_KEY_TraceDump);
+  if (trace_tuple && tuple_to_int(trace_tuple)) {
+    trace_dump_start();
+  }
+
+  Tuple *style_tuple = dict_find(iterator, MESSAGE_KEY_AnimationStyle);
+  if (style_tuple) {
+    animation_engine_set_style((AnimationStyle)tuple_to_int(style_tuple));
+    TRACE(TRACE_EVENT_PERSIST_WRITE, PERSIST_ANIMATION_STYLE);
+    persist_write_int(PERSIST_ANIMATION_STYLE, animation_engine_get_style());
+  }
+
+#if FEATURE_FLICK_SECONDS
+  Tuple *flick_tuple = dict_find(iterator, MESSAGE_KEY_SecondsOnFlick);
+  if (flick_tuple && (tuple_to_int(flick_tuple) != 0) != data->flick.enabled) {
+    set_flick_seconds(data, tuple_to_int(flick_tuple) != 0);
+    TRACE(TRACE_EVENT_PERSIST_WRITE, PERSIST_FLICK_SECONDS);
+    persist_write_bool(PERSIST_FLICK_SECONDS, data->flick.enabled);
+  }
+#endif
+
+  Tuple *fuzzy_tuple = dict_find(iterator, MESSAGE_KEY_FuzzyTime);
+  if (fuzzy_tuple && (tuple_to_int(fuzzy_tuple) != 0) != data->fuzzy.enabled) {
+    set_fuzzy_time(data, tuple_to_int(fuzzy_tuple) != 0);
+    TRACE(TRACE_EVENT_PERSIST_WRITE, PERSIST_FUZZY_TIME);
+    persist_write_bool(PERSIST_FUZZY_TIME, data->fuzzy.enabled);
+  }
+
+  Tuple *time_left_tuple = dict_find(iterator, MESSAGE_KEY_BatteryTimeLeft);
+  if (time_left_tuple && (tuple_to_int(time_left_tuple) != 0) != data->battery_time_left) {
+    data->battery_time_left = tuple_to_int(time_left_tuple) != 0;
+    TRACE(TRACE_EVENT_PERSIST_WRITE, PERSIST_BATTERY_TIME_LEFT);
+    persist_write_bool(PERSIST_BATTERY_TIME_LEFT, data->battery_time_left);
+    refresh_complication(data, COMPLICATION_BATTERY);
+  }
+
+  if (layout_update_from_message(&data->layout, iterator)) {
+    layout_save(&data->layout);
+    bool had_weather = wants_weather(data);
+    build_complications(data);
+    if (wants_weather(data) && !had_weather) request_weather();
+    make_animation();
+  }
+
+  // Coordinates arrive once per significant move, piggybacked on a weather message
+  Tuple *latitude_tuple = dict_find(iterator, MESSAGE_KEY_Latitude);
+  Tuple *longitude_tuple = dict_find(iterator, MESSAGE_KEY_Longitude);
+  if (latitude_tuple && longitude_tuple) {
+    sun_times_set_location(latitude_tuple->value->int32, longitude_tuple->value->int32);
+    data->last_sun_event = -1;
+    update_sun_display(data);
+    make_animation();
+  }
+
   Tuple *temp_tuple = dict_find(iterator, WEATHER_TEMPERATURE_KEY);
-  if (temp_tuple) {
+  if (temp_tuple && complication_enabled(data, COMPLICATION_WEATHER)) {
     int temperature = (int)temp_tuple->value->int32;
-    if (data->last_temperature != temperature) {
-      char temp_words[32];
-      number_to_words(temperature, temp_words);
-      snprintf(data->render_state.temperature[data->render_state.next_temperature], 32, "%s c", temp_words);
-      
-      // Evaluate line 1 collision: new temperature (left) vs day (right)
-      time_t now = time(NULL);
-      struct tm t = *localtime(&now);
-      char full_day[32];
-      day_to_word(t.tm_wday, full_day);
-      
-      if (check_line1_collision(data, data->render_state.temperature[data->render_state.next_temperature], full_day)) {
-        // Collision: use abbreviated day
-        day_to_short(t.tm_wday, data->render_state.days[data->render_state.next_days]);
-        slide_in_text(data, &data->day_row, data->render_state.days[data->render_state.next_days], false);
-        data->render_state.next_days = data->render_state.next_days ? 0 : 1;
-        data->collapse_state.day_collapsed = true;
-      } else {
-        // No collision: try to expand day if it was previously collapsed
-        if (data->collapse_state.day_collapsed) {
-          strcpy(data->render_state.days[data->render_state.next_days], full_day);
-          slide_in_text(data, &data->day_row, data->render_state.days[data->render_state.next_days], false);
-          data->render_state.next_days = data->render_state.next_days ? 0 : 1;
-          data->collapse_state.day_collapsed = false;
-        }
-      }
-      
-      slide_in_text(data, &data->weather_condition_row, data->render_state.temperature[data->render_state.next_temperature], false);
-      data->render_state.next_temperature = data->render_state.next_temperature ? 0 : 1;
+    if (significant(COMPLICATION_WEATHER, &data->temperature_filter, &s_temperature_policy, data->last_temperature,
+                    temperature, data->last_temperature == TEMPERATURE_NONE)) {
       data->last_temperature = temperature;
+      TRACE(TRACE_EVENT_PERSIST_WRITE, PERSIST_WEATHER_TEMPERATURE);
       persist_write_int(PERSIST_WEATHER_TEMPERATURE, temperature);
-      data->weather_changed = true;
+      refresh_complication(data, COMPLICATION_WEATHER);
       make_animation();
     }
   }
-  
+
+#if FEATURE_WEATHER_ICONS
+  Tuple *icon_tuple = dict_find(iterator, WEATHER_ICON_KEY);
+  if (icon_tuple && complication_enabled(data, COMPLICATION_CONDITION)) {
+    set_weather_icon(data, tuple_to_int(icon_tuple));
+  }
+#endif
+
   Tuple *condition_tuple = dict_find(iterator, WEATHER_CITY_KEY);
-  if (condition_tuple) {
-    strncpy(data->render_state.weather_condition[data->render_state.next_weather_condition], 
-            condition_tuple->value->cstring, 31);
-    data->render_state.weather_condition[data->render_state.next_weather_condition][31] = '\0';
-    persist_write_string(PERSIST_WEATHER_CONDITION, 
-                        data->render_state.weather_condition[data->render_state.next_weather_condition]);
-    
-    // Evaluate line 2 collision: new weather condition (left) vs date (right)
-    time_t now = time(NULL);
-    struct tm t = *localtime(&now);
-    char full_date[32];
-    day_of_month_to_words(t.tm_mday, full_date);
-    
-    if (check_line2_collision(data, data->render_state.weather_condition[data->render_state.next_weather_condition], full_date)) {
-      // Collision: use numeric date
-      date_to_short(t.tm_mday, data->render_state.dates[data->render_state.next_dates]);
-      slide_in_text(data, &data->date_row, data->render_state.dates[data->render_state.next_dates], false);
-      data->render_state.next_dates = data->render_state.next_dates ? 0 : 1;
-      data->collapse_state.date_collapsed = true;
-    } else {
-      // No collision: try to expand date if it was previously collapsed
-      if (data->collapse_state.date_collapsed) {
-        strcpy(data->render_state.dates[data->render_state.next_dates], full_date);
-        slide_in_text(data, &data->date_row, data->render_state.dates[data->render_state.next_dates], false);
-        data->render_state.next_dates = data->render_state.next_dates ? 0 : 1;
-        data->collapse_state.date_collapsed = false;
-      }
-    }
-    
-    slide_in_text(data, &data->weather_row, 
-                  data->render_state.weather_condition[data->render_state.next_weather_condition], false);
-    data->render_state.next_weather_condition = data->render_state.next_weather_condition ? 0 : 1;
-    data->weather_changed = true;
+  // The same condition again is neither redrawn nor rewritten to flash
+  if (condition_tuple && complication_enabled(data, COMPLICATION_CONDITION) &&
+      strncmp(data->weather_condition, condition_tuple->value->cstring, sizeof(data->weather_condition) - 1) != 0) {
+    strncpy(data->weather_condition, condition_tuple->value->cstring, sizeof(data->weather_condition) - 1);
+    data->weather_condition[sizeof(data->weather_condition) - 1] = '\0';
+    TRACE(TRACE_EVENT_PERSIST_WRITE, PERSIST_WEATHER_CONDITION);
+    persist_write_string(PERSIST_WEATHER_CONDITION, data->weather_condition);
+    refresh_complication(data, COMPLICATION_CONDITION);
     make_animation();
   }
 }
 
 static void inbox_dropped_callback(AppMessageResult reason, void *context) { (void)reason; (void)context; }
-static void outbox_failed_callback(DictionaryIterator *iterator, AppMessageResult reason, void *context) { (void)iterator; (void)reason; (void)context; }
-static void outbox_sent_callback(DictionaryIterator *iterator, void *context) { (void)iterator; (void)context; }
+static void outbox_failed_callback(DictionaryIterator *iterator, AppMessageResult reason, void *context) { (void)iterator; (void)reason; (void)context; trace_dump_abort(); }
+static void outbox_sent_callback(DictionaryIterator *iterator, void *context) { (void)iterator; (void)context; trace_dump_continue(); }
 
 static void request_weather(void) {
+  if (!wants_weather(s_data)) return;
   DictionaryIterator *iter;
   app_message_outbox_begin(&iter);
   if (!iter) return;
   int value = 1;
   dict_write_int(iter, 1, &value, sizeof(int), true);
+#if FEATURE_HEALTH
+  // Steps walked since the previous request let the phone skip or hasten its GPS fix
+  time_t start = time_start_of_today();
+  if (health_service_metric_accessible(HealthMetricStepCount, start, time(NULL)) & HealthServiceAccessibilityMaskAvailable) {
+    int steps = (int)health_service_sum_today(HealthMetricStepCount);
+    if (s_data->last_request_steps >= 0) {
+      // The daily total restarts at midnight
+      int moved = steps >= s_data->last_request_steps ? steps - s_data->last_request_steps : steps;
+      dict_write_int(iter, WEATHER_REQUEST_STEPS_KEY, &moved, sizeof(int), true);
+    }
+    s_data->last_request_steps = steps;
+  }
+#endif
+  // How fast this build drains the battery, for the phone's status page
+  int rate = (int)battery_history_rate();
+  if (rate > 0) dict_write_int(iter, WEATHER_REQUEST_BATTERY_RATE_KEY, &rate, sizeof(int), true);
   dict_write_end(iter);
   app_message_outbox_send();
 }
 
+// ============================================================================
+// LIFECYCLE
+// ============================================================================
+
 static void handle_deinit(void) {
+#if FEATURE_FLICK_SECONDS
+  // Before the tick unsubscribe: closing an open window resubscribes minutes
+  set_flick_seconds(s_data, false);
+#endif
   tick_timer_service_unsubscribe();
+  if (s_data->fuzzy.timer) app_timer_cancel(s_data->fuzzy.timer);
+  if (s_data->fuzzy.day_timer) app_timer_cancel(s_data->fuzzy.day_timer);
   battery_state_service_unsubscribe();
-#if defined(PBL_HEALTH)
-  health_service_events_unsubscribe();
+#if FEATURE_HEALTH
+  // The worker keeps counting after we exit, so only drop the message subscription
+  if (s_data->steps_from_worker) app_worker_message_unsubscribe();
+  if (s_data->health_subscribed) health_service_events_unsubscribe();
 #endif
-#if ANIMATION_STYLE == ANIMATION_STYLE_HACKER
-  if (s_data->hacker_timer) app_timer_cancel(s_data->hacker_timer);
+#if FEATURE_HEART_RATE
+  if (s_data->heart_rate_subscribed) heart_rate_unsubscribe(s_data);
 #endif
+  animation_engine_deinit();
+  for (int i = 0; i < COMPLICATION_COUNT; i++) {
+    destroy_complication(s_data, (Complication)i);
+  }
   free(s_data);
 }
 
 static void handle_init() {
   SlidingTextData *data = (SlidingTextData*)malloc(sizeof(SlidingTextData));
+  memset(data, 0, sizeof(SlidingTextData));
   s_data = data;
   srand(time(NULL));
-  data->hacker_timer = NULL;
   data->window_ready = false;
   data->render_state.next_hours = 0;
   data->render_state.next_minutes = 0;
-  data->render_state.next_days = 0;
-  data->render_state.next_dates = 0;
-  data->render_state.next_battery = 0;
-  data->render_state.next_temperature = 0;
-  data->render_state.next_weather_condition = 0;
-  data->render_state.next_steps = 0;
-
-  // Initialize collapse state - assume all expanded initially
-  data->collapse_state.day_collapsed = false;
-  data->collapse_state.date_collapsed = false;
-  data->collapse_state.battery_collapsed = false;
+
+  data->last_hour = -1;
+  data->last_minute = -1;
+  data->last_day = -1;
+  data->last_battery = -1;
+  data->last_temperature = TEMPERATURE_NONE;
+  data->last_steps = -1;
+  data->last_request_steps = -1;
+  data->last_sun_event = -1;
+#if FEATURE_WEATHER_ICONS
+  data->icon.id = -1;
+#endif
+
+  sun_times_init();
+  battery_history_init();
+  layout_load(&data->layout);
+  data->battery_time_left = persist_read_bool(PERSIST_BATTERY_TIME_LEFT);
+  data->fuzzy.enabled = persist_read_bool(PERSIST_FUZZY_TIME);
+
+  animation_engine_init(persist_exists(PERSIST_ANIMATION_STYLE) ?
+                        (AnimationStyle)persist_read_int(PERSIST_ANIMATION_STYLE) : ANIMATION_STYLE_DEFAULT);
+  animation_engine_set_idle_handler(prepare_next_minute);
 
   data->window = window_create();
   window_set_background_color(data->window, GColorBlack);
@@ -917,98 +1548,70 @@ static void handle_init() {
 
   Layer *window_layer = window_get_root_layer(data->window);
   const int16_t width = layer_get_bounds(window_layer).size.w;
-  const int16_t padding = 5;
-
-  init_sliding_row(data, &data->day_row, GRect(2, -2, width - padding, 60), data->gothic18_bold, 6);
-  text_layer_set_text_alignment(data->day_row.label, PBL_IF_ROUND_ELSE(GTextAlignmentCenter, GTextAlignmentRight));
-  layer_add_child(window_layer, text_layer_get_layer(data->day_row.label));
 
-  init_sliding_row(data, &data->date_row, GRect(2, 14, width - padding, 60), data->gothic18, 6);
-  text_layer_set_text_alignment(data->date_row.label, PBL_IF_ROUND_ELSE(GTextAlignmentCenter, GTextAlignmentRight));
-  layer_add_child(window_layer, text_layer_get_layer(data->date_row.label));
-
-  init_sliding_row(data, &data->hour_row, GRect(2, 26, width, 60), data->bitham42_bold, 6);
+  init_sliding_row(&data->hour_row, GRect(2, 26, width, 60), data->bitham42_bold, 6);
   layer_add_child(window_layer, text_layer_get_layer(data->hour_row.label));
 
-  init_sliding_row(data, &data->first_minute_row, GRect(2, 62, width, 96), data->bitham42_light, 3);
+  init_sliding_row(&data->first_minute_row, GRect(2, 62, width, 96), data->bitham42_light, 3);
   layer_add_child(window_layer, text_layer_get_layer(data->first_minute_row.label));
 
-  init_sliding_row(data, &data->second_minute_row, GRect(2, 98, width, 132), data->bitham42_light, 0);
+  init_sliding_row(&data->second_minute_row, GRect(2, 98, width, 132), data->bitham42_light, 0);
   layer_add_child(window_layer, text_layer_get_layer(data->second_minute_row.label));
 
-  init_sliding_row(data, &data->steps_row, GRect(2, 144, width / 2, 168), data->gothic18_bold, 6);
-  text_layer_set_text_alignment(data->steps_row.label, GTextAlignmentLeft);
-  layer_add_child(window_layer, text_layer_get_layer(data->steps_row.label));
-
-  init_sliding_row(data, &data->battery_row, GRect(2, 144, width - padding, 168), data->gothic18, 6);
-  text_layer_set_text_alignment(data->battery_row.label, PBL_IF_ROUND_ELSE(GTextAlignmentCenter, GTextAlignmentRight));
-  layer_add_child(window_layer, text_layer_get_layer(data->battery_row.label));
-
-  init_sliding_row(data, &data->weather_condition_row, GRect(2, -2, (width * 3) / 4, 60), data->gothic18_bold, 6);
-  text_layer_set_text_alignment(data->weather_condition_row.label, GTextAlignmentLeft);
-  text_layer_set_overflow_mode(data->weather_condition_row.label, GTextOverflowModeTrailingEllipsis);
-  layer_add_child(window_layer, text_layer_get_layer(data->weather_condition_row.label));
-
-  init_sliding_row(data, &data->weather_row, GRect(2, 14, (width * 3) / 4, 60), data->gothic18, 6);
-  text_layer_set_text_alignment(data->weather_row.label, GTextAlignmentLeft);
-  text_layer_set_overflow_mode(data->weather_row.label, GTextOverflowModeTrailingEllipsis);
-  layer_add_child(window_layer, text_layer_get_layer(data->weather_row.label));
-
-  if (persist_exists(PERSIST_WEATHER_TEMPERATURE)) {
-    int cached_temp = persist_read_int(PERSIST_WEATHER_TEMPERATURE);
-    char temp_words[32];
-    number_to_words(cached_temp, temp_words);
-    snprintf(data->render_state.temperature[data->render_state.next_temperature], 32, "%s c", temp_words);
-    data->last_temperature = cached_temp;
+  // Cached weather only matters for the complications that show it
+  if (layout_slot_of(&data->layout, COMPLICATION_WEATHER) != SLOT_OFF && persist_exists(PERSIST_WEATHER_TEMPERATURE)) {
+    data->last_temperature = persist_read_int(PERSIST_WEATHER_TEMPERATURE);
   }
-  
-  if (persist_exists(PERSIST_WEATHER_CONDITION)) {
-    char cached_condition[32];
-    persist_read_string(PERSIST_WEATHER_CONDITION, cached_condition, sizeof(cached_condition));
-    strncpy(data->render_state.weather_condition[data->render_state.next_weather_condition], cached_condition, 31);
-    data->render_state.weather_condition[data->render_state.next_weather_condition][31] = '\0';
+  if (layout_slot_of(&data->layout, COMPLICATION_CONDITION) != SLOT_OFF && persist_exists(PERSIST_WEATHER_CONDITION)) {
+    persist_read_string(PERSIST_WEATHER_CONDITION, data->weather_condition, sizeof(data->weather_condition));
+#if FEATURE_WEATHER_ICONS
+    if (persist_exists(PERSIST_WEATHER_ICON)) data->icon.id = persist_read_int(PERSIST_WEATHER_ICON);
+#endif
   }
 
   time_t now = time(NULL);
   struct tm t = *localtime(&now);
-  
-  hour_to_12h_word(t.tm_hour, data->render_state.hours[data->render_state.next_hours]);
-  minute_to_formal_words(t.tm_min, data->render_state.first_minutes[data->render_state.next_minutes], 
-                        data->render_state.second_minutes[data->render_state.next_minutes]);
-  
-  if (t.tm_min > 0 && t.tm_min < 10) {
-    strcpy(data->render_state.second_minutes[data->render_state.next_minutes], 
-           data->render_state.first_minutes[data->render_state.next_minutes]);
-    strcpy(data->render_state.first_minutes[data->render_state.next_minutes], "oh");
-  }
-  
-  day_to_word(t.tm_wday, data->render_state.days[data->render_state.next_days]);
-  day_of_month_to_words(t.tm_mday, data->render_state.dates[data->render_state.next_dates]);
-  
+
+  if (data->fuzzy.enabled) {
+    format_fuzzy(data, t.tm_hour, t.tm_min);
+  } else {
+    hour_to_12h_word(t.tm_hour, data->render_state.hours[data->render_state.next_hours]);
+    format_minutes(data, t.tm_min);
+  }
+
   data->last_hour = t.tm_hour;
   data->last_minute = t.tm_min;
   data->last_day = t.tm_wday;
+  data->last_tick_minute = t.tm_hour * 60 + t.tm_min;
 
-  // Subscribe to services
-  tick_timer_service_subscribe(MINUTE_UNIT, handle_minute_tick);
+  // Rows, battery and health subscriptions for whatever the layout places
+  build_complications(data);
+  // The drain rate sent to the phone needs readings whatever the layout;
+  // events only, so this costs nothing between battery changes
   battery_state_service_subscribe(handle_battery);
-  handle_battery(battery_state_service_peek());
+  battery_history_record(battery_state_service_peek(), now);
 
-#if defined(PBL_HEALTH)
-  health_service_events_subscribe(health_handler, NULL);
-  health_handler(HealthEventMovementUpdate, NULL);
+  if (data->fuzzy.enabled) {
+    schedule_fuzzy_change(data);
+    schedule_day_change(data);
+  } else {
+    tick_timer_service_subscribe(MINUTE_UNIT, handle_minute_tick);
+  }
+#if FEATURE_FLICK_SECONDS
+  set_flick_seconds(data, persist_read_bool(PERSIST_FLICK_SECONDS));
 #endif
 
+  // Settings arrive over AppMessage, so it stays open even with every weather row off
   app_message_register_inbox_received(inbox_received_callback);
   app_message_register_inbox_dropped(inbox_dropped_callback);
   app_message_register_outbox_failed(outbox_failed_callback);
   app_message_register_outbox_sent(outbox_sent_callback);
-  app_message_open(256, 256);
+  app_message_open(APP_MESSAGE_INBOX_SIZE, APP_MESSAGE_OUTBOX_SIZE);
 
   window_set_window_handlers(data->window, (WindowHandlers) {
     .appear = window_appear_handler
   });
-  
+
   window_stack_push(data->window, true);
 }
 
@@ -1016,68 +1619,36 @@ static void handle_init() {
 static void window_appear_handler(Window *window) {
   (void)window;
   SlidingTextData *data = s_data;
-  
+
   // Mark window as ready for animations
   data->window_ready = true;
-  
-#if ANIMATION_STYLE == ANIMATION_STYLE_HACKER
+
   // During night mode (midnight to 6am), skip animations to conserve battery
-  if (is_night_mode()) {
+  bool night = is_night_mode();
+  if (night) {
     // Just set all text directly without animation
-    text_layer_set_text(data->day_row.label, data->render_state.days[data->render_state.next_days]);
-    text_layer_set_text(data->date_row.label, data->render_state.dates[data->render_state.next_dates]);
-    text_layer_set_text(data->hour_row.label, data->render_state.hours[data->render_state.next_hours]);
-    text_layer_set_text(data->first_minute_row.label, data->render_state.first_minutes[data->render_state.next_minutes]);
-    text_layer_set_text(data->second_minute_row.label, data->render_state.second_minutes[data->render_state.next_minutes]);
-    
-    if (persist_exists(PERSIST_WEATHER_TEMPERATURE)) {
-      text_layer_set_text(data->weather_condition_row.label, data->render_state.temperature[data->render_state.next_temperature]);
-    }
-    if (persist_exists(PERSIST_WEATHER_CONDITION)) {
-      text_layer_set_text(data->weather_row.label, data->render_state.weather_condition[data->render_state.next_weather_condition]);
-    }
-    if (data->last_battery >= 0) {
-      uint8_t battery_idx = data->render_state.next_battery ? 0 : 1;
-      text_layer_set_text(data->battery_row.label, data->render_state.battery[battery_idx]);
-    }
-    if (data->last_steps >= 0) {
-      uint8_t steps_idx = data->render_state.next_steps ? 0 : 1;
-      text_layer_set_text(data->steps_row.label, data->render_state.steps[steps_idx]);
-    }
-    return;
+    animation_engine_show_text(&data->hour_row, data->render_state.hours[data->render_state.next_hours]);
+    animation_engine_show_text(&data->first_minute_row, data->render_state.first_minutes[data->render_state.next_minutes]);
+    animation_engine_show_text(&data->second_minute_row, data->render_state.second_minutes[data->render_state.next_minutes]);
+  } else {
+    // Set up all animations with initial scrambled text visible immediately
+    animation_engine_animate_text(&data->hour_row, data->render_state.hours[data->render_state.next_hours], false, true);
+    animation_engine_animate_text(&data->first_minute_row, data->render_state.first_minutes[data->render_state.next_minutes], false, true);
+    animation_engine_animate_text(&data->second_minute_row, data->render_state.second_minutes[data->render_state.next_minutes], false, true);
+  }
+
+  // Complication text was set during init (next toggles after data is set)
+  for (int i = 0; i < COMPLICATION_COUNT; i++) {
+    ComplicationRow *row = data->complications[i];
+    if (!row) continue;
+    char *text = row->text[row->next ? 0 : 1];
+    if (!text[0]) continue;
+    if (night) animation_engine_show_text(&row->row, text);
+    else animation_engine_animate_text(&row->row, text, true, true);
   }
-  
-  // Set up all animations with initial scrambled text visible immediately
-  start_hacker_animation(&data->day_row, data->render_state.days[data->render_state.next_days], true, true);
-  start_hacker_animation(&data->date_row, data->render_state.dates[data->render_state.next_dates], true, true);
-  start_hacker_animation(&data->hour_row, data->render_state.hours[data->render_state.next_hours], false, true);
-  start_hacker_animation(&data->first_minute_row, data->render_state.first_minutes[data->render_state.next_minutes], false, true);
-  start_hacker_animation(&data->second_minute_row, data->render_state.second_minutes[data->render_state.next_minutes], false, true);
-  
-  // Animate weather if we have cached data
-  if (persist_exists(PERSIST_WEATHER_TEMPERATURE)) {
-    start_hacker_animation(&data->weather_condition_row, data->render_state.temperature[data->render_state.next_temperature], true, true);
-  }
-  if (persist_exists(PERSIST_WEATHER_CONDITION)) {
-    start_hacker_animation(&data->weather_row, data->render_state.weather_condition[data->render_state.next_weather_condition], true, true);
-  }
-  
-  // Animate battery if data was collected during init (next_battery toggles after data is set)
-  if (data->last_battery >= 0) {
-    // Data is in the previous buffer slot since next was toggled
-    uint8_t battery_idx = data->render_state.next_battery ? 0 : 1;
-    start_hacker_animation(&data->battery_row, data->render_state.battery[battery_idx], true, true);
-  }
-  
-  // Animate steps if data was collected during init
-  if (data->last_steps >= 0) {
-    uint8_t steps_idx = data->render_state.next_steps ? 0 : 1;
-    start_hacker_animation(&data->steps_row, data->render_state.steps[steps_idx], true, true);
-  }
-  
-  // Start the animation timer with minimal delay
+
+  // Start the animation with minimal delay
   make_animation();
-#endif
 }
 
 int main(void) {
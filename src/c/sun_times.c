@@ -0,0 +1,128 @@
+#include "sun_times.h"
+#include "trace.h"
+
+// Persist key for the cached SunTimes blob, next to the app's own keys (100-102)
+#define PERSIST_SUN_TIMES 103
+
+// cos(90.833 deg): the sun's upper limb on the horizon, with refraction
+#define COS_ZENITH_RATIO -953
+
+static SunTimes s_sun;
+
+static int32_t isqrt(int64_t n) {
+  if (n <= 0) return 0;
+  int64_t x = n, y = (x + 1) / 2;
+  while (y < x) {
+    x = y;
+    y = (x + n / x) / 2;
+  }
+  return (int32_t)x;
+}
+
+static int32_t wrap_angle(int64_t angle) {
+  angle %= TRIG_MAX_ANGLE;
+  return (int32_t)(angle < 0 ? angle + TRIG_MAX_ANGLE : angle);
+}
+
+static int16_t to_local_minutes(int32_t utc_tenths, int16_t offset) {
+  int32_t minutes = (utc_tenths + 5) / 10 + offset;
+  minutes %= 24 * 60;
+  return (int16_t)(minutes < 0 ? minutes + 24 * 60 : minutes);
+}
+
+// NOAA's low-precision solar model (about a minute of error) in trig lookup units
+static void compute(SunTimes *sun, int year_day) {
+  const int64_t R = TRIG_MAX_RATIO;
+  int32_t gamma = wrap_angle((int64_t)TRIG_MAX_ANGLE * year_day / 365);
+  int32_t c1 = cos_lookup(gamma), s1 = sin_lookup(gamma);
+  int32_t c2 = cos_lookup(wrap_angle(2 * gamma)), s2 = sin_lookup(wrap_angle(2 * gamma));
+  int32_t c3 = cos_lookup(wrap_angle(3 * gamma)), s3 = sin_lookup(wrap_angle(3 * gamma));
+
+  // Declination in micro-radians (times R), then as a trig angle
+  int64_t declination_urad = 6918 * R - 399912LL * c1 + 70257LL * s1 - 6758LL * c2 +
+                             907LL * s2 - 2697LL * c3 + 1480LL * s3;
+  int32_t declination = wrap_angle(declination_urad * TRIG_MAX_ANGLE / (6283185LL * R));
+
+  // Equation of time in tenths of a minute
+  int64_t eot = 75 * R + 1868LL * c1 - 32077LL * s1 - 14615LL * c2 - 40849LL * s2;
+  int32_t eot_tenths = (int32_t)(eot * 22918 / (10000000LL * R));
+
+  int32_t latitude = wrap_angle((int64_t)sun->latitude_e4 * TRIG_MAX_ANGLE / 3600000);
+  int64_t sin_lat = sin_lookup(latitude), cos_lat = cos_lookup(latitude);
+  int64_t sin_dec = sin_lookup(declination), cos_dec = cos_lookup(declination);
+
+  // cos(hour angle) = (cos z - sin lat sin dec) / (cos lat cos dec), in R units
+  int64_t denominator = cos_lat * cos_dec / R;
+  int64_t cos_hour = denominator ? (COS_ZENITH_RATIO * R - sin_lat * sin_dec) / denominator : R;
+  if (cos_hour >= R || cos_hour <= -R) {
+    sun->polar_day = cos_hour <= -R;
+    sun->sunrise = sun->sunset = SUN_TIME_NONE;
+    return;
+  }
+
+  // atan2_lookup takes 16-bit inputs and sin_hour reaches R when cos_hour is 0,
+  // so quarter both sides of the ratio
+  int32_t sin_hour = isqrt(R * R - cos_hour * cos_hour);
+  int32_t hour_angle = atan2_lookup((int16_t)(sin_hour / 4), (int16_t)(cos_hour / 4));
+  int32_t hour_tenths_deg = (int32_t)((int64_t)hour_angle * 3600 / TRIG_MAX_ANGLE);
+  int32_t longitude_tenths_deg = sun->longitude_e4 / 1000;
+
+  // Four minutes of time per degree of longitude or hour angle
+  int32_t sunrise_tenths = 7200 - 4 * (longitude_tenths_deg + hour_tenths_deg) - eot_tenths;
+  int32_t sunset_tenths = 7200 - 4 * (longitude_tenths_deg - hour_tenths_deg) - eot_tenths;
+  sun->polar_day = false;
+  sun->sunrise = to_local_minutes(sunrise_tenths, sun->utc_offset_minutes);
+  sun->sunset = to_local_minutes(sunset_tenths, sun->utc_offset_minutes);
+}
+
+static int16_t utc_offset_minutes(time_t now) {
+  struct tm local = *localtime(&now);
+  struct tm utc = *gmtime(&now);
+  int offset = (local.tm_hour - utc.tm_hour) * 60 + (local.tm_min - utc.tm_min);
+  if (local.tm_year != utc.tm_year) {
+    offset += local.tm_year > utc.tm_year ? 24 * 60 : -24 * 60;
+  } else if (local.tm_yday != utc.tm_yday) {
+    offset += local.tm_yday > utc.tm_yday ? 24 * 60 : -24 * 60;
+  }
+  return (int16_t)offset;
+}
+
+void sun_times_init(void) {
+  memset(&s_sun, 0, sizeof(s_sun));
+  s_sun.sunrise = s_sun.sunset = SUN_TIME_NONE;
+  if (persist_get_size(PERSIST_SUN_TIMES) == (int)sizeof(s_sun)) {
+    persist_read_data(PERSIST_SUN_TIMES, &s_sun, sizeof(s_sun));
+  }
+}
+
+void sun_times_set_location(int32_t latitude_e4, int32_t longitude_e4) {
+  if (s_sun.has_location && s_sun.latitude_e4 == latitude_e4 && s_sun.longitude_e4 == longitude_e4) return;
+  s_sun.latitude_e4 = latitude_e4;
+  s_sun.longitude_e4 = longitude_e4;
+  s_sun.has_location = true;
+  s_sun.day_key = 0;  // recompute on the next query
+  // The phone won't send it again until the wearer moves, so keep it even while
+  // the sun row is off and nothing queries the times
+  TRACE(TRACE_EVENT_PERSIST_WRITE, PERSIST_SUN_TIMES);
+  persist_write_data(PERSIST_SUN_TIMES, &s_sun, sizeof(s_sun));
+}
+
+bool sun_times_has_location(void) {
+  return s_sun.has_location;
+}
+
+const SunTimes *sun_times_for(time_t now) {
+  if (!s_sun.has_location) return &s_sun;
+
+  struct tm t = *localtime(&now);
+  int32_t day_key = (t.tm_year + 1900) * 1000 + t.tm_yday;
+  int16_t offset = utc_offset_minutes(now);
+  if (day_key == s_sun.day_key && offset == s_sun.utc_offset_minutes) return &s_sun;
+
+  s_sun.day_key = day_key;
+  s_sun.utc_offset_minutes = offset;
+  compute(&s_sun, t.tm_yday);
+  TRACE(TRACE_EVENT_PERSIST_WRITE, PERSIST_SUN_TIMES);
+  persist_write_data(PERSIST_SUN_TIMES, &s_sun, sizeof(s_sun));
+  return &s_sun;
+}
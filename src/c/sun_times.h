@@ -0,0 +1,25 @@
+#pragma once
+
+#include <pebble.h>
+
+// Minutes value for a sun event that doesn't happen today (polar day/night)
+#define SUN_TIME_NONE -1
+
+typedef struct {
+  int32_t latitude_e4, longitude_e4;  // degrees * 10000, east positive
+  int32_t day_key;                    // year * 1000 + day of year the times are for
+  int16_t utc_offset_minutes;
+  int16_t sunrise, sunset;            // local minutes after midnight, or SUN_TIME_NONE
+  bool has_location;
+  bool polar_day;                     // no sunrise or sunset because the sun stays up
+} SunTimes;
+
+// Load the cached location and times from persist
+void sun_times_init(void);
+// The phone sends coordinates once per significant move; they are persisted right
+// away and the times follow on the next query
+void sun_times_set_location(int32_t latitude_e4, int32_t longitude_e4);
+bool sun_times_has_location(void);
+// Times for the local date of `now`; only recomputed when the date, UTC offset
+// or location changed since the cached result
+const SunTimes *sun_times_for(time_t now);
@@ -0,0 +1,78 @@
+#include "trace.h"
+
+#if TRACE_ENABLED
+
+static TraceEvent s_ring[TRACE_RING_SIZE];
+static uint16_t s_head;   // next slot to write
+static uint16_t s_count;  // valid events, up to TRACE_RING_SIZE
+
+// Recording pauses while a dump is streaming so chunk indices stay stable
+static bool s_dumping;
+static uint16_t s_dump_chunk, s_dump_total;
+
+void trace_record(TraceEventType type, uint16_t arg) {
+  if (s_dumping) return;
+
+  time_t seconds;
+  uint16_t millis;
+  time_ms(&seconds, &millis);
+
+  TraceEvent *event = &s_ring[s_head];
+  event->timestamp_ms = (uint32_t)seconds * 1000 + millis;
+  event->type = type;
+  event->reserved = 0;
+  event->arg = arg;
+
+  s_head = (s_head + 1) % TRACE_RING_SIZE;
+  if (s_count < TRACE_RING_SIZE) s_count++;
+}
+
+static void send_chunk(void) {
+  DictionaryIterator *iter;
+  app_message_outbox_begin(&iter);
+  if (!iter) {
+    s_dumping = false;
+    return;
+  }
+
+  // Oldest event first
+  TraceEvent chunk[TRACE_EVENTS_PER_CHUNK];
+  uint16_t first = s_dump_chunk * TRACE_EVENTS_PER_CHUNK;
+  uint16_t oldest = (s_head + TRACE_RING_SIZE - s_count) % TRACE_RING_SIZE;
+  uint16_t n = 0;
+  for (uint16_t i = first; i < s_count && n < TRACE_EVENTS_PER_CHUNK; i++, n++) {
+    chunk[n] = s_ring[(oldest + i) % TRACE_RING_SIZE];
+  }
+
+  dict_write_uint16(iter, TRACE_CHUNK_INDEX_KEY, s_dump_chunk);
+  dict_write_uint16(iter, TRACE_CHUNK_TOTAL_KEY, s_dump_total);
+  dict_write_data(iter, TRACE_CHUNK_KEY, (const uint8_t *)chunk, n * sizeof(TraceEvent));
+  dict_write_end(iter);
+  app_message_outbox_send();
+}
+
+void trace_dump_start(void) {
+  if (s_dumping) return;
+  s_dumping = true;
+  s_dump_chunk = 0;
+  s_dump_total = (s_count + TRACE_EVENTS_PER_CHUNK - 1) / TRACE_EVENTS_PER_CHUNK;
+  if (s_dump_total == 0) s_dump_total = 1;
+  send_chunk();
+}
+
+// Called once the previous chunk has been acknowledged
+void trace_dump_continue(void) {
+  if (!s_dumping) return;
+  s_dump_chunk++;
+  if (s_dump_chunk >= s_dump_total) {
+    s_dumping = false;
+    return;
+  }
+  send_chunk();
+}
+
+void trace_dump_abort(void) {
+  s_dumping = false;
+}
+
+#endif
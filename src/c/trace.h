@@ -0,0 +1,53 @@
+#pragma once
+
+#include <pebble.h>
+#include "feature_profile.h"
+
+// Set TRACE_ENABLED to 0 to compile every trace hook out; the build profile decides by default
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED FEATURE_TRACE
+#endif
+
+#define TRACE_RING_SIZE 128
+#define TRACE_EVENTS_PER_CHUNK 24
+
+// AppMessage keys for streaming the ring to the phone
+enum TraceKey {
+  TRACE_CHUNK_KEY = 0x20,        // byte array of packed TraceEvents
+  TRACE_CHUNK_INDEX_KEY = 0x21,
+  TRACE_CHUNK_TOTAL_KEY = 0x22,
+};
+
+typedef enum {
+  TRACE_EVENT_TICK = 1,
+  TRACE_EVENT_HEALTH = 2,
+  TRACE_EVENT_BATTERY = 3,
+  TRACE_EVENT_INBOX = 4,
+  TRACE_EVENT_SLIDE_IN = 5,
+  TRACE_EVENT_FRAME_BEGIN = 6,
+  TRACE_EVENT_FRAME_END = 7,
+  TRACE_EVENT_PERSIST_WRITE = 8,
+  TRACE_EVENT_FILTERED = 9,     // a reading too small to show; arg is the Complication
+  TRACE_EVENT_PRECOMPUTE = 10,  // next minute prepared while idle; arg is its minute
+} TraceEventType;
+
+// 8 bytes on the wire, little endian; tools/trace_to_chrome.py decodes this layout
+typedef struct __attribute__((packed)) {
+  uint32_t timestamp_ms;
+  uint8_t type;
+  uint8_t reserved;
+  uint16_t arg;
+} TraceEvent;
+
+#if TRACE_ENABLED
+void trace_record(TraceEventType type, uint16_t arg);
+void trace_dump_start(void);
+void trace_dump_continue(void);
+void trace_dump_abort(void);
+#define TRACE(type, arg) trace_record((type), (uint16_t)(arg))
+#else
+#define TRACE(type, arg)
+#define trace_dump_start()
+#define trace_dump_continue()
+#define trace_dump_abort()
+#endif
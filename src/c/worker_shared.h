@@ -0,0 +1,26 @@
+#pragma once
+
+// State shared between the watchface and its background worker
+// (worker_src/c/sliding_text_worker.c). Include after pebble.h or
+// pebble_worker.h.
+
+// The worker owns this persist key; the watchface only reads it
+#define WORKER_PERSIST_SNAPSHOT 105
+#define WORKER_SNAPSHOT_VERSION 2
+
+// Battery history lives with the watchface (battery_history.c), which subscribes
+// for it whatever the layout; the worker only runs with the step count placed.
+// Time off screen is a gap between two readings, and the next drop is fitted
+// over the whole of it.
+// Weather isn't here either: a worker can't use AppMessage, and the face already
+// persists the last reading it showed
+typedef struct __attribute__((packed)) {
+  uint8_t version;
+  uint32_t steps_day;                   // time_start_of_today() the total belongs to
+  int32_t steps;
+} WorkerSnapshot;
+
+// app_worker_send_message types; steps are split over data0 (low) and data1 (high)
+enum WorkerMessageType {
+  WORKER_MESSAGE_STEPS = 1,
+};
@@ -1,3 +1,22 @@
+// Values match the watch's Slot enum in complications.h
+function slotSelect(messageKey, label, defaultValue) {
+  return {
+    "type": "select",
+    "messageKey": messageKey,
+    "label": label,
+    "defaultValue": defaultValue,
+    "options": [
+      { "label": "Off", "value": "0" },
+      { "label": "Top line, left", "value": "1" },
+      { "label": "Top line, right", "value": "2" },
+      { "label": "Second line, left", "value": "3" },
+      { "label": "Second line, right", "value": "4" },
+      { "label": "Bottom line, left", "value": "5" },
+      { "label": "Bottom line, right", "value": "6" }
+    ]
+  };
+}
+
 module.exports = [
   {
     "type": "heading",
@@ -5,7 +24,7 @@ module.exports = [
   },
   {
     "type": "text",
-    "defaultValue": "View weather and GPS status, and manually refresh data."
+    "defaultValue": "View weather and GPS latency, and manually refresh data."
   },
   {
     "type": "section",
@@ -16,10 +35,78 @@ module.exports = [
       },
       {
         "type": "text",
-        "defaultValue": "Check the app logs for current weather and GPS status. Stats are logged to the console when you open this page."
+        "defaultValue": "Where weather update time goes on this phone. Times are bucketed, so the median and p90 are upper bounds."
+      },
+      {
+        "type": "text",
+        "id": "latency-stats",
+        "defaultValue": "No statistics recorded yet."
       }
     ]
   },
+  {
+    "type": "section",
+    "items": [
+      {
+        "type": "heading",
+        "defaultValue": "Appearance"
+      },
+      {
+        "type": "select",
+        "messageKey": "AnimationStyle",
+        "label": "Animation Style",
+        "defaultValue": "0",
+        "options": [
+          { "label": "Hacker", "value": "0" },
+          { "label": "Slide", "value": "1" },
+          { "label": "Instant (lowest power)", "value": "2" }
+        ]
+      },
+      {
+        "type": "toggle",
+        "messageKey": "SecondsOnFlick",
+        "label": "Flick your wrist to show seconds",
+        "description": "Seconds replace the bottom line for ten seconds. Off, the watch doesn't listen for flicks at all.",
+        "defaultValue": false,
+        "capabilities": ["NOT_PLATFORM_APLITE"]
+      },
+      {
+        "type": "toggle",
+        "messageKey": "BatteryTimeLeft",
+        "label": "Show battery as time left",
+        "description": "Once the watch has timed how fast the charge drops, the battery item shows how long it has left instead of the percentage. Charging still shows the percentage.",
+        "defaultValue": false
+      },
+      {
+        "type": "toggle",
+        "messageKey": "FuzzyTime",
+        "label": "Fuzzy time",
+        "description": "The time to the nearest five minutes, like \"quarter to three\". The watch wakes up only when that changes, a fifth as often.",
+        "defaultValue": false
+      }
+    ]
+  },
+  {
+    "type": "section",
+    "items": [
+      {
+        "type": "heading",
+        "defaultValue": "Layout"
+      },
+      {
+        "type": "text",
+        "defaultValue": "Place each item on a line, or turn it off. Items that are off use no memory and no battery. If two items share a place, the one listed first is shown."
+      },
+      slotSelect("WeatherSlot", "Temperature", "1"),
+      slotSelect("ConditionSlot", "Weather condition", "3"),
+      slotSelect("StepsSlot", "Step count", "5"),
+      slotSelect("BatterySlot", "Battery", "6"),
+      slotSelect("DaySlot", "Day", "2"),
+      slotSelect("DateSlot", "Date", "4"),
+      slotSelect("SunSlot", "Next sunrise/sunset", "0"),
+      slotSelect("HeartRateSlot", "Heart rate (watches with a heart rate sensor)", "0")
+    ]
+  },
   {
     "type": "section",
     "items": [
@@ -39,6 +126,22 @@ module.exports = [
       }
     ]
   },
+  {
+    "type": "section",
+    "items": [
+      {
+        "type": "heading",
+        "defaultValue": "Diagnostics"
+      },
+      {
+        "type": "toggle",
+        "messageKey": "TraceDump",
+        "label": "Send event trace to phone on save",
+        "description": "The watch streams its recent event trace to the app logs. Convert it with tools/trace_to_chrome.py. Only builds with FEATURE_PROFILE=full record a trace.",
+        "defaultValue": false
+      }
+    ]
+  },
   {
     "type": "section",
     "items": [
@@ -48,11 +151,11 @@ module.exports = [
       },
       {
         "type": "text",
-        "defaultValue": "Weather updates every 15 minutes"
+        "defaultValue": "Weather updates every 10 minutes to 2 hours, sooner when the forecast is changing"
       },
       {
         "type": "text",
-        "defaultValue": "GPS cached for 3 hours"
+        "defaultValue": "GPS cached for 3 hours, longer while you stay put and shorter while you walk"
       }
     ]
   }
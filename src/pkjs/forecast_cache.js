@@ -0,0 +1,128 @@
+// Recent forecasts keyed by coarse geohash, kept across restarts in localStorage
+// so going back to a place seen lately (home, office, gym) needs no API call
+
+var STORAGE_KEY = 'forecast-cache';
+// Before this cache, only the last weather message was kept for when the quota ran out
+var LEGACY_STORAGE_KEY = 'cached-weather';
+
+var MAX_ENTRIES = 6;
+// Five characters are cells of about 5 x 5 km, well inside one forecast's area
+var GEOHASH_PRECISION = 5;
+var GEOHASH_ALPHABET = '0123456789bcdefghjkmnpqrstuvwxyz';
+var PERIOD_MS = 3 * 60 * 60 * 1000;
+
+function geohash(latitude, longitude) {
+  var latRange = [-90, 90];
+  var lonRange = [-180, 180];
+  var hash = '';
+  var bits = 0;
+  var value = 0;
+  var even = true;
+  while (hash.length < GEOHASH_PRECISION) {
+    var range = even ? lonRange : latRange;
+    var coordinate = even ? longitude : latitude;
+    var mid = (range[0] + range[1]) / 2;
+    value <<= 1;
+    if (coordinate >= mid) {
+      value |= 1;
+      range[0] = mid;
+    } else {
+      range[1] = mid;
+    }
+    even = !even;
+    if (++bits === 5) {
+      hash += GEOHASH_ALPHABET.charAt(value);
+      bits = 0;
+      value = 0;
+    }
+  }
+  return hash;
+}
+
+// Most recently used first
+function load() {
+  localStorage.removeItem(LEGACY_STORAGE_KEY);
+  try {
+    var stored = JSON.parse(localStorage.getItem(STORAGE_KEY));
+    if (Array.isArray(stored)) {
+      return stored;
+    }
+  } catch (e) {
+    console.log('Discarding unreadable forecast cache');
+  }
+  return [];
+}
+
+var entries = load();
+
+function save() {
+  localStorage.setItem(STORAGE_KEY, JSON.stringify(entries));
+}
+
+// Only the fields the watch message is built from, to keep entries small
+function trim(forecastList) {
+  return forecastList.map(function(period) {
+    return {
+      dt: period.dt,
+      main: { temp: period.main.temp },
+      weather: [{ id: period.weather[0].id, main: period.weather[0].main }]
+    };
+  });
+}
+
+// Periods already over are dropped so the timeline starts at the current one
+function fromNow(entry, now) {
+  var list = entry.list.filter(function(period) {
+    return !period.dt || period.dt * 1000 + PERIOD_MS > now;
+  });
+  return list.length ? list : entry.list.slice(-1);
+}
+
+// fetchedAt and validFor (ms) decide how long the forecast serves its cell
+function put(latitude, longitude, forecastList, fetchedAt, validFor) {
+  var cell = geohash(latitude, longitude);
+  entries = entries.filter(function(entry) { return entry.cell !== cell; });
+  entries.unshift({ cell: cell, time: fetchedAt, validFor: validFor, list: trim(forecastList) });
+  entries.length = Math.min(entries.length, MAX_ENTRIES);
+  save();
+}
+
+// The still valid forecast for the cell around a position, or null
+function get(latitude, longitude, now) {
+  var cell = geohash(latitude, longitude);
+  for (var i = 0; i < entries.length; i++) {
+    var entry = entries[i];
+    if (entry.cell !== cell) {
+      continue;
+    }
+    if (now - entry.time >= entry.validFor) {
+      return null;
+    }
+    if (i > 0) {
+      entries.splice(i, 1);
+      entries.unshift(entry);
+      save();
+    }
+    return { list: fromNow(entry, now), time: entry.time, validFor: entry.validFor };
+  }
+  return null;
+}
+
+// Whatever was fetched last, however old, for when no fetch can be made; get()
+// moves entries to the front as they're used, so look at the fetch times
+function latest(now) {
+  var entry = null;
+  for (var i = 0; i < entries.length; i++) {
+    if (!entry || entries[i].time > entry.time) {
+      entry = entries[i];
+    }
+  }
+  return entry ? { list: fromNow(entry, now), time: entry.time, validFor: entry.validFor } : null;
+}
+
+module.exports = {
+  geohash: geohash,
+  put: put,
+  get: get,
+  latest: latest
+};
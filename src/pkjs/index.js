@@ -1,7 +1,51 @@
-// Import Clay for configuration
-var Clay = require('pebble-clay');
-var clayConfig = require('./config');
-var clay = new Clay(clayConfig);
+// Startup latency: time from script evaluation to the first weather reaching the watch
+var startupTime = Date.now();
+var firstWeatherSent = false;
+
+var messageKeys = require('message_keys');
+var latencyStats = require('./latency_stats');
+var forecastCache = require('./forecast_cache');
+
+// Clay and the config page are only needed when the settings page opens,
+// so they are required lazily instead of slowing down every startup
+var clay = null;
+
+// The Status section's placeholder becomes the latency stats and battery drain as of now
+function configWithStatus(clayConfig) {
+  var config = JSON.parse(JSON.stringify(clayConfig));
+  config.forEach(function(section) {
+    if (!section.items) {
+      return;
+    }
+    section.items = section.items.reduce(function(items, item) {
+      return items.concat(item.id === 'latency-stats' ? latencyStats.clayItems().concat([batteryDrainItem()]) : [item]);
+    }, []);
+  });
+  return config;
+}
+
+// The watch measures its own discharge rate and reports it with weather requests
+function batteryDrainItem() {
+  var rate = JSON.parse(localStorage.getItem(BATTERY_DRAIN_STORAGE_KEY) || 'null');
+  return {
+    type: 'text',
+    defaultValue: '<b>Battery drain</b>: ' + (rate ?
+      (rate * 24 / 1000).toFixed(1) + '% a day with this watch face' : 'not measured yet')
+  };
+}
+
+// rebuild: regenerate the page so the status is current
+function getClay(rebuild) {
+  if (!clay || rebuild) {
+    var loadStart = Date.now();
+    var Clay = require('pebble-clay');
+    var clayConfig = require('./config');
+    // Events are handled below so status can be logged and refreshes triggered
+    clay = new Clay(configWithStatus(clayConfig), null, { autoHandleEvents: false });
+    console.log('Clay loaded in ' + (Date.now() - loadStart) + ' ms');
+  }
+  return clay;
+}
 
 // OpenWeatherMap API Key - Get one free at https://openweathermap.org/appid
 // The API key is automatically injected from WEATHER_SECRET environment variable during build
@@ -15,49 +59,299 @@ if (!myAPIKey || myAPIKey === 'WEATHER_API_KEY_PLACEHOLDER') {
 }
 
 // BATTERY OPTIMIZATION STRATEGY:
-// - GPS cached for 3 hours (major battery saver - GPS is expensive)
-// - Weather fetched every 15 minutes using cached GPS
-// - Weather refreshed at startup and when data is older than 15 minutes
+// - GPS cached for 3 hours (major battery saver - GPS is expensive), stretched to
+//   12 hours while the watch reports the wearer standing still and cut to 30 minutes
+//   while they are walking a lot
+// - Weather fetched every 10 minutes to 2 hours using cached GPS, depending on
+//   how volatile the forecast is and how much of the daily API budget is left
+// - Weather refreshed at startup and when data is older than the current interval
+// - Forecasts for the last few places are kept, so a fix somewhere visited lately
+//   shows that place's forecast at once without an API call
+// - When the GPS cache runs out, weather for the last known position is fetched
+//   while a coarse fix is taken; only a fix far from it fetches again
 // - Only updates when data actually changes
 
-// GPS cache - updated every 3 hours
-var cachedLocation = null;
+// GPS cache - updated every 3 hours. The last fix is kept across restarts so even
+// a cold start has somewhere to fetch for, but only a fix taken since counts as fresh
+var LAST_LOCATION_STORAGE_KEY = 'last-location';
+var cachedLocation = loadLastLocation();
 var lastLocationTime = 0;
 var GPS_CACHE_DURATION = 3 * 60 * 60 * 1000; // 3 hours in milliseconds
+var GPS_CACHE_DURATION_STILL = 12 * 60 * 60 * 1000; // 12 hours when barely moving
+var GPS_CACHE_DURATION_MOVING = 30 * 60 * 1000; // 30 minutes when moving a lot
+
+// Speculative fetch: while a fix is taken, weather is fetched for the last one
+var REFETCH_DISTANCE_KM = 2; // a fix closer than this to the guess gets the same forecast
+
+// Motion-aware GPS: the watch reports steps walked since its previous weather request
+var WATCH_STEPS_KEY = 3;
+var STILL_STEPS_THRESHOLD = 300;    // fewer steps than this since the fix: treat as stationary
+var MOVING_STEPS_THRESHOLD = 2000;  // more steps than this since the fix: treat as on the move
+var stepsSinceLocationFix = null;   // null until the watch reports movement (no health data)
+
+// Thousandths of a percent per hour, as the watch's battery history measured it
+var WATCH_BATTERY_RATE_KEY = 4;
+var BATTERY_DRAIN_STORAGE_KEY = 'battery-drain';
 
 // Weather update tracking
 var lastWeatherUpdate = 0;
-var WEATHER_UPDATE_INTERVAL = 15 * 60 * 1000; // 15 minutes in milliseconds
+var weatherRequestTime = 0;  // when the update now in flight was started, for end-to-end latency
+// While GPS checks a guess: { guess, deliveredAt, confirmed }. Weather for the
+// guess only counts as delivered once the fix lands near it
+var speculation = null;
+var WEATHER_UPDATE_INTERVAL = 15 * 60 * 1000; // 15 minutes in milliseconds (until a forecast arrives)
+var MIN_WEATHER_UPDATE_INTERVAL = 10 * 60 * 1000; // 10 minutes
+var MAX_WEATHER_UPDATE_INTERVAL = 2 * 60 * 60 * 1000; // 2 hours
+var weatherUpdateInterval = WEATHER_UPDATE_INTERVAL;
+
+// Forecast volatility thresholds
+var INCOMING_WEATHER_SOON_HOURS = 3;   // inclement weather this close refreshes at the minimum interval
+var STEEP_TEMPERATURE_TREND = 3;       // degrees C per 3 hour period
 
-// API call limiting (1000 calls/day free tier)
+// API quota (1000 calls/day free tier, counted per UTC day by the provider),
+// persisted in localStorage. A small token bucket refilled at the daily rate paces
+// the calls, and a count of today's calls is a hard cap whose last
+// API_EMERGENCY_RESERVE calls are kept for "Refresh Weather Now". A 429 empties
+// the bucket until the provider's next UTC midnight; without tokens the last
+// forecast is served instead
 var API_DAILY_LIMIT = 900; // Set to 900 to leave safety margin
-var apiCallCount = 0;
-var apiCallResetTime = 0;
+var API_BURST_CAPACITY = 10;
+var API_EMERGENCY_RESERVE = 20;
+var DAY_MS = 24 * 60 * 60 * 1000;
+var API_REFILL_INTERVAL = DAY_MS / API_DAILY_LIMIT;
+var API_QUOTA_STORAGE_KEY = 'api-quota';
+var apiQuota = loadApiQuota();
 
-function checkAndResetApiCounter() {
-  var now = Date.now();
-  var oneDayMs = 24 * 60 * 60 * 1000;
+// Sunrise/sunset are computed on the watch, which only needs coordinates when they move
+var SUN_LOCATION_STORAGE_KEY = 'sun-location';
+var SUN_LOCATION_THRESHOLD = 0.1; // degrees, well under a minute of sun time
+
+// Event trace: after a TraceDump request the watch streams its trace ring in chunks
+var TRACE_CHUNK_KEY = 0x20;
+var TRACE_CHUNK_INDEX_KEY = 0x21;
+var TRACE_CHUNK_TOTAL_KEY = 0x22;
+var traceBytes = [];
+
+function handleTraceChunk(payload) {
+  var index = payload[TRACE_CHUNK_INDEX_KEY];
+  var total = payload[TRACE_CHUNK_TOTAL_KEY];
+  if (index === 0) {
+    traceBytes = [];
+  }
+  traceBytes = traceBytes.concat(payload[TRACE_CHUNK_KEY] || []);
   
-  // Reset counter if it's a new day
-  if (now - apiCallResetTime > oneDayMs) {
-    console.log('Resetting API call counter for new day');
-    apiCallCount = 0;
-    apiCallResetTime = now;
+  if (index + 1 >= total) {
+    // One line per dump so tools/trace_to_chrome.py can pick it out of the logs
+    var hex = traceBytes.map(function(b) {
+      return ('0' + (b & 0xff).toString(16)).slice(-2);
+    }).join('');
+    console.log('TRACE_DUMP ' + hex);
+    traceBytes = [];
+  }
+}
+
+function locationCacheDuration() {
+  if (stepsSinceLocationFix === null) {
+    return GPS_CACHE_DURATION;
+  }
+  if (stepsSinceLocationFix < STILL_STEPS_THRESHOLD) {
+    return GPS_CACHE_DURATION_STILL;
+  }
+  if (stepsSinceLocationFix > MOVING_STEPS_THRESHOLD) {
+    return GPS_CACHE_DURATION_MOVING;
+  }
+  return GPS_CACHE_DURATION;
+}
+
+function loadLastLocation() {
+  try {
+    var stored = JSON.parse(localStorage.getItem(LAST_LOCATION_STORAGE_KEY));
+    if (stored && typeof stored.latitude === 'number' && typeof stored.longitude === 'number') {
+      return { latitude: stored.latitude, longitude: stored.longitude };
+    }
+  } catch (e) {
+    console.log('Discarding unreadable last location');
   }
+  return null;
+}
+
+// Equirectangular approximation, plenty at the few km that matter here
+function distanceKm(from, to) {
+  var toRadians = Math.PI / 180;
+  var x = (to.longitude - from.longitude) * toRadians *
+          Math.cos((from.latitude + to.latitude) / 2 * toRadians);
+  var y = (to.latitude - from.latitude) * toRadians;
+  return Math.sqrt(x * x + y * y) * 6371;
+}
+
+function utcDay(time) {
+  return Math.floor(time / DAY_MS);
+}
+
+function nextUtcMidnight(time) {
+  return (utcDay(time) + 1) * DAY_MS;
 }
 
-function canMakeApiCall() {
-  checkAndResetApiCounter();
-  if (apiCallCount >= API_DAILY_LIMIT) {
-    console.error('API daily limit reached (' + apiCallCount + '/' + API_DAILY_LIMIT + '). Skipping weather update.');
+function loadApiQuota() {
+  var now = Date.now();
+  var quota = { tokens: API_BURST_CAPACITY, updated: now, day: utcDay(now), used: 0, blockedUntil: 0 };
+  try {
+    var stored = JSON.parse(localStorage.getItem(API_QUOTA_STORAGE_KEY));
+    if (stored && typeof stored.tokens === 'number' && typeof stored.updated === 'number') {
+      // Quotas saved before the daily count only have the bucket, and a bigger one
+      quota.tokens = Math.min(API_BURST_CAPACITY, stored.tokens);
+      quota.updated = stored.updated;
+      if (typeof stored.day === 'number' && typeof stored.used === 'number') {
+        quota.day = stored.day;
+        quota.used = stored.used;
+      }
+      if (typeof stored.blockedUntil === 'number') {
+        quota.blockedUntil = stored.blockedUntil;
+      }
+    }
+  } catch (e) {
+    console.log('Discarding unreadable API quota');
+  }
+  return quota;
+}
+
+function saveApiQuota() {
+  localStorage.setItem(API_QUOTA_STORAGE_KEY, JSON.stringify(apiQuota));
+}
+
+function refillApiQuota() {
+  var now = Date.now();
+  if (utcDay(now) !== apiQuota.day) {
+    apiQuota.day = utcDay(now);
+    apiQuota.used = 0;
+  }
+  // Nothing accrues while the provider has us blocked
+  var elapsed = now - Math.max(apiQuota.updated, apiQuota.blockedUntil);
+  if (now >= apiQuota.blockedUntil && elapsed > 0) {
+    apiQuota.tokens = Math.min(API_BURST_CAPACITY, apiQuota.tokens + elapsed / API_REFILL_INTERVAL);
+  }
+  apiQuota.updated = now;
+}
+
+// A manual refresh skips the pacing but not the daily cap
+function hasApiToken(emergency) {
+  refillApiQuota();
+  if (Date.now() < apiQuota.blockedUntil) {
+    return false;
+  }
+  if (emergency) {
+    return apiQuota.used < API_DAILY_LIMIT;
+  }
+  return apiQuota.tokens >= 1 && apiQuota.used < API_DAILY_LIMIT - API_EMERGENCY_RESERVE;
+}
+
+function takeApiToken(emergency) {
+  if (!hasApiToken(emergency)) {
+    console.error('API quota exhausted (' + apiQuota.used + '/' + API_DAILY_LIMIT + ' calls today, ' +
+                  apiQuota.tokens.toFixed(1) + ' tokens). Skipping weather update.');
     return false;
   }
+  apiQuota.tokens = Math.max(0, apiQuota.tokens - 1);
+  apiQuota.used++;
+  saveApiQuota();
+  console.log('API calls today: ' + apiQuota.used + '/' + API_DAILY_LIMIT + ', tokens left: ' + apiQuota.tokens.toFixed(1));
   return true;
 }
 
-function incrementApiCallCount() {
-  apiCallCount++;
-  console.log('API calls today: ' + apiCallCount + '/' + API_DAILY_LIMIT);
+// The provider answered 429: nothing more until its quota resets at UTC midnight
+function blockApiUntilReset() {
+  var now = Date.now();
+  apiQuota.tokens = 0;
+  apiQuota.updated = now;
+  apiQuota.blockedUntil = nextUtcMidnight(now);
+  saveApiQuota();
+  console.log('API rate limited until ' + new Date(apiQuota.blockedUntil).toISOString());
+}
+
+// Spread the calls left today, above the reserve, over what is left of the UTC
+// day; only binds once most of the day's budget is spent
+function minimumIntervalForBudget() {
+  refillApiQuota();
+  var now = Date.now();
+  var left = API_DAILY_LIMIT - API_EMERGENCY_RESERVE - apiQuota.used;
+  return (nextUtcMidnight(now) - now) / Math.max(1, left);
+}
+
+function sunLocationUpdate(latitude, longitude) {
+  var sent = JSON.parse(localStorage.getItem(SUN_LOCATION_STORAGE_KEY) || 'null');
+  if (sent && Math.abs(sent.latitude - latitude) < SUN_LOCATION_THRESHOLD &&
+      Math.abs(sent.longitude - longitude) < SUN_LOCATION_THRESHOLD) {
+    return null;
+  }
+  return { latitude: latitude, longitude: longitude };
+}
+
+// The watch only shows weather (and needs the location) if the layout places
+// temperature, condition or sunrise/sunset somewhere; Clay keeps select values as strings
+function weatherWanted() {
+  var settings = JSON.parse(localStorage.getItem('clay-settings') || '{}');
+  var defaults = { WeatherSlot: '1', ConditionSlot: '3', SunSlot: '0' };
+  return Object.keys(defaults).some(function(key) {
+    var slot = settings[key] !== undefined ? settings[key] : defaults[key];
+    return String(slot) !== '0';
+  });
+}
+
+// Out of quota: the last forecast fetched anywhere, however old, beats nothing
+function serveCachedWeather() {
+  var cached = forecastCache.latest(Date.now());
+  if (!cached) {
+    return;
+  }
+  console.log('Serving cached weather from ' + getTimeAgo(cached.time));
+  latencyStats.count('weatherCacheHits');
+  sendForecast(cached.list, null, null, cached.time, true);
+}
+
+// A forecast for this place that is still valid makes the API call unnecessary
+function serveCachedForecast(latitude, longitude) {
+  var now = Date.now();
+  var cached = forecastCache.get(latitude, longitude, now);
+  if (!cached) {
+    return false;
+  }
+  console.log('Serving cached forecast for ' + forecastCache.geohash(latitude, longitude) +
+              ' from ' + getTimeAgo(cached.time));
+  latencyStats.count('forecastCacheHits');
+  // Due for a refresh when the cached forecast would have been
+  weatherUpdateInterval = cached.validFor;
+  sendForecast(cached.list, latitude, longitude, cached.time, false);
+  return true;
+}
+
+function computeRefreshInterval(forecastList) {
+  var current = forecastList[0];
+  var incoming = findIncomingWeather(forecastList);
+  var interval;
+
+  if (isInclementWeather(current.weather[0].id) ||
+      (incoming && incoming.hoursAway <= INCOMING_WEATHER_SOON_HOURS)) {
+    // Conditions are changing now or within a few hours
+    interval = MIN_WEATHER_UPDATE_INTERVAL;
+  } else {
+    // Scale between the bounds by how settled the forecast looks
+    var maxSeverity = 0;
+    for (var i = 0; i < forecastList.length; i++) {
+      maxSeverity = Math.max(maxSeverity, getWeatherSeverity(forecastList[i].weather[0].id));
+    }
+    interval = incoming ? WEATHER_UPDATE_INTERVAL * 2 :
+               (maxSeverity <= 1 ? MAX_WEATHER_UPDATE_INTERVAL : WEATHER_UPDATE_INTERVAL * 4);
+
+    if (forecastList.length > 1) {
+      var trend = Math.abs(forecastList[1].main.temp - current.main.temp);
+      if (trend >= STEEP_TEMPERATURE_TREND) {
+        interval = Math.min(interval, WEATHER_UPDATE_INTERVAL);
+      }
+    }
+  }
+
+  interval = Math.max(interval, minimumIntervalForBudget());
+  return Math.min(Math.max(interval, MIN_WEATHER_UPDATE_INTERVAL), MAX_WEATHER_UPDATE_INTERVAL);
 }
 
 function iconFromWeatherId(weatherId) {
@@ -115,9 +409,114 @@ function formatConditionWithTiming(condition, hoursAway) {
   }
 }
 
-function fetchWeather(latitude, longitude) {
-  if (!canMakeApiCall()) {
-    console.log('Skipping weather fetch - daily limit reached');
+// fetchedAt: when the forecast came from the API, which is what its age counts
+// from; stale: sent for lack of anything better, so it doesn't count as fresh.
+// Without coordinates the sunrise/sunset location is left alone
+function sendForecast(forecastList, latitude, longitude, fetchedAt, stale) {
+  // Get current conditions from first forecast period
+  var current = forecastList[0];
+  var currentTemp = Math.round(current.main.temp - 273.15);
+  var currentWeatherId = current.weather[0].id;
+  var currentCondition = current.weather[0].main.toLowerCase();
+  
+  // Check for incoming inclement weather in next 3 periods (9 hours)
+  var incoming = findIncomingWeather(forecastList);
+  
+  var temperature, condition, icon;
+  
+  if (incoming && !isInclementWeather(currentWeatherId)) {
+    // Bad weather is coming and it's not currently bad, show timing
+    temperature = currentTemp;
+    condition = formatConditionWithTiming(incoming.condition, incoming.hoursAway);
+    icon = iconFromWeatherId(incoming.weatherId);
+    console.log('Incoming weather: ' + incoming.condition + ' in ' + incoming.hoursAway + ' hours');
+  } else {
+    // Show current weather
+    temperature = currentTemp;
+    condition = currentCondition;
+    icon = iconFromWeatherId(currentWeatherId);
+    console.log('Current weather: ' + condition);
+  }
+  
+  console.log('Temperature: ' + temperature + 'C');
+  console.log('Condition: ' + condition);
+  console.log('Icon: ' + icon);
+  
+  // Send using numeric keys
+  var dict = {
+    0: icon,              // WEATHER_ICON_KEY
+    1: temperature,       // WEATHER_TEMPERATURE_KEY
+    2: condition          // WEATHER_CITY_KEY (now condition)
+  };
+  var sunLocation = latitude !== null ? sunLocationUpdate(latitude, longitude) : null;
+  if (sunLocation) {
+    dict[messageKeys.Latitude] = Math.round(latitude * 10000);
+    dict[messageKeys.Longitude] = Math.round(longitude * 10000);
+  }
+  console.log('Sending to watch: ' + JSON.stringify(dict));
+  var ackDone = latencyStats.start('ack');
+  Pebble.sendAppMessage(dict,
+    function(e) {
+      console.log('Weather sent successfully!');
+      ackDone();
+      var sentTime = Date.now();
+      if (!stale) {
+        lastWeatherUpdate = fetchedAt;
+      }
+      if (weatherRequestTime) {
+        var forGuess = speculation && latitude === speculation.guess.latitude &&
+                       longitude === speculation.guess.longitude;
+        if (!forGuess) {
+          finishWeatherRequest(sentTime);
+        } else {
+          latencyStats.record('guessEndToEnd', sentTime - weatherRequestTime);
+          speculation.deliveredAt = sentTime;
+          if (speculation.confirmed) {
+            finishWeatherRequest(sentTime);
+          }
+        }
+      }
+      if (sunLocation) {
+        localStorage.setItem(SUN_LOCATION_STORAGE_KEY, JSON.stringify(sunLocation));
+      }
+      if (!firstWeatherSent) {
+        firstWeatherSent = true;
+        console.log('Startup to first weather send: ' + (sentTime - startupTime) + ' ms');
+      }
+    },
+    function(e) {
+      console.log('Failed to send weather: ' + JSON.stringify(e));
+      latencyStats.count('ackFailures');
+    }
+  );
+}
+
+function finishWeatherRequest(deliveredAt) {
+  latencyStats.record('endToEnd', deliveredAt - weatherRequestTime);
+  weatherRequestTime = 0;
+  speculation = null;
+}
+
+// The fix landed near the guess, or never came: weather for the guess was the
+// right weather, and if it's already on the watch that's when the update finished.
+// A fix far away leaves the update to the fetch for the fix
+function confirmSpeculation() {
+  if (!speculation) {
+    return;
+  }
+  if (speculation.deliveredAt && weatherRequestTime) {
+    finishWeatherRequest(speculation.deliveredAt);
+  } else {
+    speculation.confirmed = true;
+  }
+}
+
+function fetchWeather(latitude, longitude, emergency) {
+  // A manual refresh always asks the API
+  if (!emergency && serveCachedForecast(latitude, longitude)) {
+    return;
+  }
+  if (!takeApiToken(emergency)) {
     return;
   }
   
@@ -125,74 +524,43 @@ function fetchWeather(latitude, longitude) {
   var url = 'http://api.openweathermap.org/data/2.5/forecast?lat=' + latitude + '&lon=' + longitude + '&cnt=6&appid=' + myAPIKey;
   console.log('Fetching forecast...');
   
-  incrementApiCallCount();
-  
   var req = new XMLHttpRequest();
+  var httpDone = latencyStats.start('http');
   req.open('GET', url, true);
   req.onload = function () {
     if (req.readyState === 4) {
+      httpDone();
       if (req.status === 200) {
         console.log('Forecast API Response received');
+        var parseDone = latencyStats.start('parse');
         var response = JSON.parse(req.responseText);
+        parseDone();
         
-        // Get current conditions from first forecast period
-        var current = response.list[0];
-        var currentTemp = Math.round(current.main.temp - 273.15);
-        var currentWeatherId = current.weather[0].id;
-        var currentCondition = current.weather[0].main.toLowerCase();
-        
-        // Check for incoming inclement weather in next 3 periods (9 hours)
-        var incoming = findIncomingWeather(response.list);
+        weatherUpdateInterval = computeRefreshInterval(response.list);
+        console.log('Next weather refresh in ' + Math.round(weatherUpdateInterval / 60000) + ' minutes');
         
-        var temperature, condition, icon;
-        
-        if (incoming && !isInclementWeather(currentWeatherId)) {
-          // Bad weather is coming and it's not currently bad, show timing
-          temperature = currentTemp;
-          condition = formatConditionWithTiming(incoming.condition, incoming.hoursAway);
-          icon = iconFromWeatherId(incoming.weatherId);
-          console.log('Incoming weather: ' + incoming.condition + ' in ' + incoming.hoursAway + ' hours');
-        } else {
-          // Show current weather
-          temperature = currentTemp;
-          condition = currentCondition;
-          icon = iconFromWeatherId(currentWeatherId);
-          console.log('Current weather: ' + condition);
-        }
-        
-        console.log('Temperature: ' + temperature + 'C');
-        console.log('Condition: ' + condition);
-        console.log('Icon: ' + icon);
-        
-        // Send using numeric keys
-        var dict = {
-          0: icon,              // WEATHER_ICON_KEY
-          1: temperature,       // WEATHER_TEMPERATURE_KEY
-          2: condition          // WEATHER_CITY_KEY (now condition)
-        };
-        console.log('Sending to watch: ' + JSON.stringify(dict));
-        Pebble.sendAppMessage(dict,
-          function(e) {
-            console.log('Weather sent successfully!');
-            lastWeatherUpdate = Date.now();
-          },
-          function(e) {
-            console.log('Failed to send weather: ' + JSON.stringify(e));
-          }
-        );
+        var fetchedAt = Date.now();
+        forecastCache.put(latitude, longitude, response.list, fetchedAt, weatherUpdateInterval);
+        sendForecast(response.list, latitude, longitude, fetchedAt, false);
       } else {
         console.log('Weather API Error: ' + req.status);
         console.log('Response: ' + req.responseText);
+        latencyStats.count('httpFailures');
+        if (req.status === 429) {
+          blockApiUntilReset();
+        }
       }
     }
   };
   req.onerror = function() {
     console.log('Weather API request failed');
+    latencyStats.count('httpFailures');
   };
   req.send(null);
 }
 
-function locationSuccess(pos) {
+// guess: the position weather was already fetched for while GPS ran, if any
+function locationSuccess(pos, emergency, guess) {
   var coordinates = pos.coords;
   // Cache the location
   cachedLocation = {
@@ -200,18 +568,40 @@ function locationSuccess(pos) {
     longitude: coordinates.longitude
   };
   lastLocationTime = Date.now();
+  if (stepsSinceLocationFix !== null) {
+    stepsSinceLocationFix = 0;
+  }
+  localStorage.setItem(LAST_LOCATION_STORAGE_KEY, JSON.stringify(cachedLocation));
   console.log('GPS location cached: ' + cachedLocation.latitude + ', ' + cachedLocation.longitude);
   
-  fetchWeather(coordinates.latitude, coordinates.longitude);
+  if (guess) {
+    var moved = distanceKm(guess, cachedLocation);
+    if (moved < REFETCH_DISTANCE_KM) {
+      console.log('Fix is ' + moved.toFixed(1) + ' km from the guess, keeping its weather');
+      confirmSpeculation();
+      return;
+    }
+    console.log('Fix is ' + moved.toFixed(1) + ' km from the guess, fetching again');
+    latencyStats.count('speculationMisses');
+  }
+  fetchWeather(coordinates.latitude, coordinates.longitude, emergency);
 }
 
-function locationError(err) {
+function locationError(err, emergency, guess) {
   console.warn('location error (' + err.code + '): ' + err.message);
+  latencyStats.count('gpsFailures');
+  
+  // Weather for the last known position is already on its way
+  if (guess) {
+    confirmSpeculation();
+    return;
+  }
   
   // If we have a cached location, use it
   if (cachedLocation) {
     console.log('Using cached location due to GPS error');
-    fetchWeather(cachedLocation.latitude, cachedLocation.longitude);
+    latencyStats.count('locationCacheHits');
+    fetchWeather(cachedLocation.latitude, cachedLocation.longitude, emergency);
   } else {
     Pebble.sendAppMessage({
       2: 'error',        // WEATHER_CITY_KEY
@@ -226,23 +616,57 @@ function locationError(err) {
   }
 }
 
-function getWeather(forceUpdate) {
+// emergency: a manual refresh, which may spend the reserved API tokens
+function getWeather(forceUpdate, emergency) {
+  if (!weatherWanted()) {
+    console.log('No weather rows in the layout, skipping update');
+    return;
+  }
+  
   var now = Date.now();
   var timeSinceLastLocation = now - lastLocationTime;
   var timeSinceLastWeather = now - lastWeatherUpdate;
   
-  // Force update if requested, at startup, or if weather is older than 15 minutes
-  if (forceUpdate || lastWeatherUpdate === 0 || timeSinceLastWeather >= WEATHER_UPDATE_INTERVAL) {
+  // Force update if requested, at startup, or if weather is older than the adaptive interval
+  if (forceUpdate || lastWeatherUpdate === 0 || timeSinceLastWeather >= weatherUpdateInterval) {
     console.log('Weather update needed (age: ' + Math.round(timeSinceLastWeather / 60000) + ' minutes)');
     
-    // If we have a cached location and it's less than 3 hours old, use it
-    if (cachedLocation && timeSinceLastLocation < GPS_CACHE_DURATION) {
+    // Out of quota: don't wake the GPS for a fetch that can't happen
+    if (!hasApiToken(emergency)) {
+      console.log('No API tokens left for this update');
+      if (forceUpdate) {
+        serveCachedWeather();
+      }
+      return;
+    }
+    
+    weatherRequestTime = now;
+    speculation = null;
+    
+    // If we have a cached location that is still fresh for how much the wearer has moved, use it
+    if (cachedLocation && timeSinceLastLocation < locationCacheDuration()) {
       console.log('Using cached GPS location (age: ' + Math.round(timeSinceLastLocation / 60000) + ' minutes)');
-      fetchWeather(cachedLocation.latitude, cachedLocation.longitude);
+      latencyStats.count('locationCacheHits');
+      fetchWeather(cachedLocation.latitude, cachedLocation.longitude, emergency);
     } else {
       // Location is stale or doesn't exist, get fresh GPS
       console.log('Requesting fresh GPS location (cache age: ' + Math.round(timeSinceLastLocation / 60000) + ' minutes)');
-      window.navigator.geolocation.getCurrentPosition(locationSuccess, locationError, locationOptions);
+      // Most of the time the wearer is still near the last fix: fetch for it now
+      // instead of after the fix, and settle for a coarse, possibly recent fix
+      var guess = cachedLocation;
+      var options = locationOptions;
+      if (guess) {
+        console.log('Fetching weather for the last known location while GPS runs');
+        latencyStats.count('speculativeFetches');
+        speculation = { guess: guess, deliveredAt: 0, confirmed: false };
+        fetchWeather(guess.latitude, guess.longitude, emergency);
+        options = speculativeLocationOptions;
+      }
+      var gpsDone = latencyStats.start('gps');
+      window.navigator.geolocation.getCurrentPosition(
+        function(pos) { gpsDone(); locationSuccess(pos, emergency, guess); },
+        function(err) { locationError(err, emergency, guess); },
+        options);
     }
   } else {
     console.log('Weather is fresh, skipping update (age: ' + Math.round(timeSinceLastWeather / 60000) + ' minutes)');
@@ -254,6 +678,13 @@ var locationOptions = {
   'maximumAge': 60000
 };
 
+// Only checks the guess, so a network fix or one the phone took lately will do
+var speculativeLocationOptions = {
+  'enableHighAccuracy': false,
+  'timeout': 15000,
+  'maximumAge': 10 * 60 * 1000
+};
+
 // Helper to format time ago
 function getTimeAgo(timestamp) {
   if (!timestamp || timestamp === 0) {
@@ -267,7 +698,7 @@ function getTimeAgo(timestamp) {
 }
 
 Pebble.addEventListener('ready', function (e) {
-  console.log('PebbleKit JS ready!');
+  console.log('PebbleKit JS ready after ' + (Date.now() - startupTime) + ' ms');
   
   // Force fetch weather on startup to ensure fresh data
   getWeather(true);
@@ -280,7 +711,31 @@ Pebble.addEventListener('ready', function (e) {
 });
 
 Pebble.addEventListener('appmessage', function (e) {
+  if (e.payload && e.payload[TRACE_CHUNK_INDEX_KEY] !== undefined) {
+    handleTraceChunk(e.payload);
+    return;
+  }
+  
   console.log('Received message from watch, requesting weather update');
+  
+  var batteryRate = e.payload ? e.payload[WATCH_BATTERY_RATE_KEY] : undefined;
+  if (typeof batteryRate === 'number') {
+    localStorage.setItem(BATTERY_DRAIN_STORAGE_KEY, JSON.stringify(batteryRate));
+  }
+  
+  var steps = e.payload ? e.payload[WATCH_STEPS_KEY] : undefined;
+  if (typeof steps === 'number') {
+    stepsSinceLocationFix = (stepsSinceLocationFix || 0) + steps;
+    console.log('Steps since last GPS fix: ' + stepsSinceLocationFix);
+    
+    // Walking a long way makes both the location and the weather stale
+    if (cachedLocation && locationCacheDuration() === GPS_CACHE_DURATION_MOVING &&
+        Date.now() - lastLocationTime >= GPS_CACHE_DURATION_MOVING) {
+      getWeather(true);
+      return;
+    }
+  }
+  
   getWeather();
 });
 
@@ -293,7 +748,7 @@ Pebble.addEventListener('showConfiguration', function(e) {
   console.log('Cached Location: ' + (cachedLocation ? cachedLocation.latitude.toFixed(4) + ', ' + cachedLocation.longitude.toFixed(4) : 'None'));
   console.log('API Key Status: ' + ((myAPIKey && myAPIKey !== 'WEATHER_API_KEY_PLACEHOLDER') ? 'Configured' : 'Missing'));
   console.log('---------------------');
-  Pebble.openURL(clay.generateUrl());
+  Pebble.openURL(getClay(true).generateUrl());
 });
 
 // Handle configuration close
@@ -304,13 +759,30 @@ Pebble.addEventListener('webviewclosed', function(e) {
   }
 
   // Get the Clay response
-  var dict = clay.getSettings(e.response);
+  var dict = getClay().getSettings(e.response);
   console.log('Config response:', JSON.stringify(dict));
   
+  // Deliver settings (animation style, trace dump request) to the watch
+  Pebble.sendAppMessage(dict,
+    function(e) {
+      console.log('Settings sent to watch');
+    },
+    function(e) {
+      console.log('Failed to send settings: ' + JSON.stringify(e));
+    }
+  );
+  
+  // A trace dump is a one-off action, don't leave the toggle on for next time
+  if (dict && dict[messageKeys.TraceDump]) {
+    var stored = JSON.parse(localStorage.getItem('clay-settings') || '{}');
+    stored.TraceDump = false;
+    localStorage.setItem('clay-settings', JSON.stringify(stored));
+  }
+  
   // Check if refresh buttons were clicked
   if (dict && dict['refresh-weather']) {
     console.log('Refresh weather button clicked');
-    getWeather(true);
+    getWeather(true, true);
   }
   
   if (dict && dict['refresh-gps']) {
@@ -318,6 +790,6 @@ Pebble.addEventListener('webviewclosed', function(e) {
     // Force GPS refresh by invalidating cache
     lastLocationTime = 0;
     cachedLocation = null;
-    getWeather(true);
+    getWeather(true, true);
   }
 });
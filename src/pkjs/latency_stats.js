@@ -0,0 +1,149 @@
+// Where weather latency comes from, kept across restarts in localStorage and
+// shown in the Status section of the settings page
+
+var STORAGE_KEY = 'latency-stats';
+
+// Upper bounds of the histogram buckets in ms; a last, open-ended bucket follows
+var BUCKET_BOUNDS = [100, 250, 500, 1000, 2500, 5000, 10000, 30000];
+
+var TIMINGS = {
+  gps: 'GPS fix',
+  http: 'HTTP fetch',
+  parse: 'JSON parse',
+  ack: 'Watch ack',
+  endToEnd: 'Request to display',
+  guessEndToEnd: 'Request to display, last position'
+};
+
+var COUNTERS = {
+  gpsFailures: 'GPS failures',
+  httpFailures: 'HTTP failures',
+  ackFailures: 'Watch send failures',
+  locationCacheHits: 'Cached GPS used',
+  speculativeFetches: 'Fetched for the last position while GPS ran',
+  speculationMisses: 'Fetched again after moving',
+  forecastCacheHits: 'Cached forecast for the place used',
+  weatherCacheHits: 'Cached weather served'
+};
+
+function emptyStats() {
+  var stats = { since: Date.now(), timings: {}, counters: {} };
+  Object.keys(TIMINGS).forEach(function(name) {
+    stats.timings[name] = { buckets: BUCKET_BOUNDS.map(function() { return 0; }).concat([0]), count: 0, sum: 0, max: 0 };
+  });
+  Object.keys(COUNTERS).forEach(function(name) {
+    stats.counters[name] = 0;
+  });
+  return stats;
+}
+
+function load() {
+  try {
+    var stored = JSON.parse(localStorage.getItem(STORAGE_KEY));
+    if (stored && stored.timings && stored.counters) {
+      // Metrics added since the stats were saved start from zero
+      var fresh = emptyStats();
+      Object.keys(fresh.timings).forEach(function(name) {
+        if (!stored.timings[name] || stored.timings[name].buckets.length !== fresh.timings[name].buckets.length) {
+          stored.timings[name] = fresh.timings[name];
+        }
+      });
+      Object.keys(fresh.counters).forEach(function(name) {
+        stored.counters[name] = stored.counters[name] || 0;
+      });
+      return stored;
+    }
+  } catch (e) {
+    console.log('Discarding unreadable latency stats');
+  }
+  return emptyStats();
+}
+
+var stats = load();
+
+function save() {
+  localStorage.setItem(STORAGE_KEY, JSON.stringify(stats));
+}
+
+function record(name, ms) {
+  var timing = stats.timings[name];
+  var bucket = 0;
+  while (bucket < BUCKET_BOUNDS.length && ms > BUCKET_BOUNDS[bucket]) {
+    bucket++;
+  }
+  timing.buckets[bucket]++;
+  timing.count++;
+  timing.sum += ms;
+  timing.max = Math.max(timing.max, ms);
+  save();
+}
+
+function count(name) {
+  stats.counters[name]++;
+  save();
+}
+
+// Returns a function that records the time since it was created
+function start(name) {
+  var startTime = Date.now();
+  return function() {
+    record(name, Date.now() - startTime);
+  };
+}
+
+function formatMs(ms) {
+  return ms < 1000 ? Math.round(ms) + ' ms' : (ms / 1000).toFixed(1) + ' s';
+}
+
+// The bucket bound under which a share of the samples fall
+function percentile(timing, share) {
+  var target = timing.count * share;
+  var seen = 0;
+  for (var i = 0; i < timing.buckets.length; i++) {
+    seen += timing.buckets[i];
+    if (seen >= target) {
+      return i < BUCKET_BOUNDS.length ? '≤' + formatMs(BUCKET_BOUNDS[i]) : '>' + formatMs(BUCKET_BOUNDS[i - 1]);
+    }
+  }
+  return '-';
+}
+
+function describeTiming(name) {
+  var timing = stats.timings[name];
+  if (timing.count === 0) {
+    return '<b>' + TIMINGS[name] + '</b>: no samples yet';
+  }
+  var histogram = timing.buckets.map(function(n, i) {
+    return (i < BUCKET_BOUNDS.length ? '≤' + formatMs(BUCKET_BOUNDS[i]) : 'more') + ' ' + n;
+  }).filter(function(text, i) {
+    return timing.buckets[i] > 0;
+  }).join(', ');
+  return '<b>' + TIMINGS[name] + '</b>: ' + timing.count + ' samples, mean ' + formatMs(timing.sum / timing.count) +
+         ', median ' + percentile(timing, 0.5) + ', p90 ' + percentile(timing, 0.9) +
+         ', max ' + formatMs(timing.max) + '<br>' + histogram;
+}
+
+// Clay text items summarizing everything recorded so far
+function clayItems() {
+  var items = [{
+    type: 'text',
+    defaultValue: 'Recorded since ' + new Date(stats.since).toLocaleString()
+  }];
+  Object.keys(TIMINGS).forEach(function(name) {
+    items.push({ type: 'text', defaultValue: describeTiming(name) });
+  });
+  items.push({
+    type: 'text',
+    defaultValue: Object.keys(COUNTERS).map(function(name) {
+      return COUNTERS[name] + ': ' + stats.counters[name];
+    }).join('<br>')
+  });
+  return items;
+}
+
+module.exports = {
+  record: record,
+  count: count,
+  start: start,
+  clayItems: clayItems
+};
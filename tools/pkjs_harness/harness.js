@@ -0,0 +1,537 @@
+// Node harness for the phone side of the watchface.
+//
+// Loads src/pkjs/index.js as PebbleKit JS would, with shims for Pebble,
+// navigator.geolocation, localStorage and XMLHttpRequest, and plays a scenario
+// against it on a virtual clock: hours of app time run in well under a second.
+// Weather comes from the stand-in in weather_server.js.
+//
+//   node harness.js                  run every scenario
+//   node harness.js startup gps-timeout
+//   node harness.js -v               with the app's console output
+//   node harness.js --json           reports as JSON, e.g. to diff two branches
+//
+// Per scenario it reports API calls (and how the stand-in answered them), GPS
+// requests, AppMessages sent and the end-to-end latency from a watch request
+// (or startup) to the watch acking the weather it caused.
+'use strict';
+
+var fs = require('fs');
+var path = require('path');
+var vm = require('vm');
+var weatherServer = require('./weather_server');
+
+var ROOT = path.join(__dirname, '..', '..');
+var PKJS_DIR = path.join(ROOT, 'src', 'pkjs');
+var FIRST_MESSAGE_KEY = 10000;
+
+var MINUTE = 60 * 1000;
+var HOUR = 60 * MINUTE;
+// Runs start at a fixed wall time so sunrise and refresh decisions repeat
+var START_TIME = Date.UTC(2024, 5, 1, 7, 0, 0);
+// Where the wearer is unless a scenario moves them, as [at, latitude, longitude]
+var HOME = [0, 51.5072, -0.1276];
+
+// Watch-side keys, see src/c/sliding_text_pp.c
+var WEATHER_TEMPERATURE_KEY = 1;
+var WEATHER_CITY_KEY = 2;
+var WEATHER_REQUEST_STEPS_KEY = 3;
+
+// ============================================================================
+// SCENARIOS
+// ============================================================================
+
+// Each scenario lists what the watch and the wearer do; times are ms from start.
+//   restarts     app restarts (phone app killed, Bluetooth reconnects, ...)
+//   gps          { latencyMs: [min, max], timeoutRate, places } for position
+//                requests; places are [at, latitude, longitude], home by default
+//   server       options for createWeatherServer
+//   storage      localStorage contents before the first start
+var SCENARIOS = [
+  {
+    name: 'startup',
+    description: 'cold start, then a settled day of watch requests',
+    durationMs: 12 * HOUR,
+    gps: { latencyMs: [1500, 6000] },
+    server: { fixtures: ['forecast_clear.json'] }
+  },
+  {
+    name: 'commute',
+    description: 'two days between home, office and the gym on the way back',
+    durationMs: 48 * HOUR,
+    stepsPerRequest: 1200,
+    gps: {
+      latencyMs: [1500, 6000],
+      places: [0, 24 * HOUR].reduce(function(places, day) {
+        return places.concat([[day + 2 * HOUR, 51.5155, -0.0922], [day + 10 * HOUR, 51.4613, -0.1156],
+                              [day + 12 * HOUR, 51.5072, -0.1276]]);
+      }, [])
+    },
+    server: {}
+  },
+  {
+    name: 'reconnect-storm',
+    description: 'app restarted every 20 s for 5 minutes, as a flaky Bluetooth link does',
+    durationMs: 2 * HOUR,
+    restarts: range(20 * 1000, 5 * MINUTE, 20 * 1000),
+    gps: { latencyMs: [1500, 6000] },
+    server: {}
+  },
+  {
+    name: 'gps-timeout',
+    description: 'no position fix ever arrives',
+    durationMs: 6 * HOUR,
+    gps: { latencyMs: [1500, 6000], timeoutRate: 1 },
+    server: {}
+  },
+  {
+    name: 'quota-exhaustion',
+    description: 'rain keeps refreshes at the minimum interval until the API answers 429',
+    durationMs: 12 * HOUR,
+    gps: { latencyMs: [1500, 6000] },
+    server: { fixtures: ['forecast_rain.json'], dailyLimit: 10 },
+    storage: { 'api-quota': JSON.stringify({ tokens: 30, updated: START_TIME }) }
+  }
+];
+
+function range(from, to, step) {
+  var values = [];
+  for (var at = from; at <= to; at += step) {
+    values.push(at);
+  }
+  return values;
+}
+
+// ============================================================================
+// VIRTUAL CLOCK
+// ============================================================================
+
+function createClock(start) {
+  var clock = { now: start };
+  var timers = [];
+  var nextId = 1;
+
+  clock.schedule = function(owner, fn, delay, repeat) {
+    var timer = { id: nextId++, owner: owner, fn: fn, at: clock.now + Math.max(0, delay || 0), repeat: repeat ? Math.max(1, delay) : 0 };
+    timers.push(timer);
+    return timer.id;
+  };
+
+  clock.cancel = function(id) {
+    timers = timers.filter(function(timer) { return timer.id !== id; });
+  };
+
+  // A restarted app loses its timers
+  clock.cancelOwner = function(owner) {
+    timers = timers.filter(function(timer) { return timer.owner !== owner; });
+  };
+
+  // Fire everything due up to `until`, earliest first and in scheduling order on ties
+  clock.runUntil = function(until) {
+    for (;;) {
+      var due = null;
+      timers.forEach(function(timer) {
+        if (timer.at <= until && (!due || timer.at < due.at || (timer.at === due.at && timer.id < due.id))) {
+          due = timer;
+        }
+      });
+      if (!due) {
+        break;
+      }
+      clock.now = due.at;
+      if (due.repeat) {
+        due.at += due.repeat;
+      } else {
+        clock.cancel(due.id);
+      }
+      due.fn();
+    }
+    clock.now = until;
+  };
+
+  return clock;
+}
+
+// ============================================================================
+// SHIMS
+// ============================================================================
+
+function createStorage(initial) {
+  var items = new Map(Object.entries(initial || {}));
+  return {
+    getItem: function(key) { return items.has(String(key)) ? items.get(String(key)) : null; },
+    setItem: function(key, value) { items.set(String(key), String(value)); },
+    removeItem: function(key) { items.delete(String(key)); },
+    clear: function() { items.clear(); },
+    key: function(index) { return Array.from(items.keys())[index] || null; },
+    get length() { return items.size; }
+  };
+}
+
+function loadMessageKeys() {
+  var keys = JSON.parse(fs.readFileSync(path.join(ROOT, 'package.json'), 'utf8')).pebble.messageKeys || [];
+  var table = {};
+  var next = FIRST_MESSAGE_KEY;
+  keys.forEach(function(entry) {
+    var match = /^(\w+)(?:\[(\d+)\])?$/.exec(entry);
+    table[match[1]] = next;
+    next += parseInt(match[2] || '1', 10);
+  });
+  return table;
+}
+
+// Only what index.js uses of Clay; the page itself is never rendered here
+function ClayStub(config) {
+  this.config = config;
+}
+ClayStub.prototype.generateUrl = function() {
+  return 'data:text/html,clay';
+};
+ClayStub.prototype.getSettings = function(response) {
+  return JSON.parse(decodeURIComponent(response));
+};
+
+// One running copy of the bundle, as after each app start on the phone
+function startApp(run, generation) {
+  var clock = run.clock;
+  var listeners = {};
+  var log = run.verbose ? function(level) {
+    return function() {
+      var args = Array.prototype.slice.call(arguments);
+      console.log('[' + ((clock.now - START_TIME) / 1000).toFixed(1) + 's #' + generation + ' ' + level + '] ' + args.join(' '));
+    };
+  } : function() { return function() {}; };
+
+  function FakeDate() {
+    var args = Array.prototype.slice.call(arguments);
+    return args.length ? new (Function.prototype.bind.apply(Date, [null].concat(args)))() : new Date(clock.now);
+  }
+  FakeDate.now = function() { return clock.now; };
+  FakeDate.UTC = Date.UTC;
+  FakeDate.parse = Date.parse;
+  FakeDate.prototype = Date.prototype;
+
+  var Pebble = {
+    addEventListener: function(type, fn) {
+      (listeners[type] = listeners[type] || []).push(fn);
+    },
+    sendAppMessage: function(dict, success, failure) {
+      run.metrics.messagesSent++;
+      var weather = dict[WEATHER_TEMPERATURE_KEY] !== undefined && dict[WEATHER_CITY_KEY] !== 'error';
+      if (weather) {
+        run.metrics.weatherMessages++;
+      }
+      run.inFlight++;
+      clock.schedule(generation, function() {
+        run.inFlight--;
+        run.messageAcked(weather);
+        if (success) {
+          success({ data: dict });
+        }
+      }, randomBetween(run.random, run.scenario.ackLatencyMs || [80, 400]));
+    },
+    openURL: function() {},
+    getAccountToken: function() { return 'harness-account'; },
+    getWatchToken: function() { return 'harness-watch'; }
+  };
+
+  var geolocation = {
+    getCurrentPosition: function(success, error, options) {
+      var gps = run.scenario.gps || {};
+      var timeout = options && options.timeout !== undefined ? options.timeout : Infinity;
+      var latency = randomBetween(run.random, gps.latencyMs || [1000, 3000]);
+      run.metrics.gpsRequests++;
+      run.inFlight++;
+      if (run.random() < (gps.timeoutRate || 0) || latency > timeout) {
+        run.metrics.gpsTimeouts++;
+        clock.schedule(generation, function() {
+          run.inFlight--;
+          error({ code: 3, message: 'Timeout expired' });
+        }, timeout);
+        return;
+      }
+      var place = (gps.places || []).reduce(function(found, candidate) {
+        return START_TIME + candidate[0] <= clock.now ? candidate : found;
+      }, HOME);
+      clock.schedule(generation, function() {
+        run.inFlight--;
+        success({ coords: { latitude: place[1], longitude: place[2], accuracy: 30 }, timestamp: clock.now });
+      }, latency);
+    },
+    watchPosition: function() { return 0; },
+    clearWatch: function() {}
+  };
+
+  function XMLHttpRequest() {
+    this.readyState = 0;
+    this.status = 0;
+    this.responseText = '';
+  }
+  XMLHttpRequest.prototype.open = function(method, url) {
+    this.url = url;
+    this.readyState = 1;
+  };
+  XMLHttpRequest.prototype.send = function() {
+    var request = this;
+    var reply = run.server.handle(request.url);
+    run.inFlight++;
+    clock.schedule(generation, function() {
+      run.inFlight--;
+      if (reply.status === 0) {
+        if (request.onerror) {
+          request.onerror({});
+        }
+        return;
+      }
+      request.readyState = 4;
+      request.status = reply.status;
+      request.responseText = reply.body;
+      if (request.onload) {
+        request.onload({});
+      }
+    }, reply.latencyMs);
+  };
+
+  var sandbox = {
+    console: { log: log('log'), info: log('info'), warn: log('warn'), error: log('error') },
+    Date: FakeDate,
+    setTimeout: function(fn, delay) { return clock.schedule(generation, run.track(fn), delay, false); },
+    setInterval: function(fn, delay) { return clock.schedule(generation, run.track(fn), delay, true); },
+    clearTimeout: function(id) { clock.cancel(id); },
+    clearInterval: function(id) { clock.cancel(id); },
+    Pebble: Pebble,
+    localStorage: run.storage,
+    navigator: { geolocation: geolocation },
+    XMLHttpRequest: XMLHttpRequest
+  };
+  sandbox.window = sandbox;
+  var context = vm.createContext(sandbox);
+
+  var modules = {};
+  var messageKeys = loadMessageKeys();
+  function requireModule(name) {
+    if (name === 'message_keys') {
+      return messageKeys;
+    }
+    if (name === 'pebble-clay') {
+      return ClayStub;
+    }
+    var file = path.join(PKJS_DIR, name.replace(/\.js$/, '') + '.js');
+    if (!modules[file]) {
+      var module = modules[file] = { exports: {} };
+      var source = fs.readFileSync(file, 'utf8');
+      if (path.basename(file) === 'index.js') {
+        // A key, as the wscript injects at build time; the stand-in ignores it
+        source = source.replace("var myAPIKey = 'WEATHER_API_KEY_PLACEHOLDER'", "var myAPIKey = 'harness-key'");
+      }
+      var wrapper = vm.runInContext('(function (require, module, exports) {' + source + '\n})', context, { filename: file });
+      wrapper(requireModule, module, module.exports);
+    }
+    return modules[file].exports;
+  }
+  requireModule('./index');
+
+  return {
+    generation: generation,
+    dispatch: function(type, event) {
+      (listeners[type] || []).forEach(function(fn) {
+        fn(event || {});
+      });
+    }
+  };
+}
+
+function randomBetween(random, bounds) {
+  return Math.round(bounds[0] + random() * (bounds[1] - bounds[0]));
+}
+
+// ============================================================================
+// RUN
+// ============================================================================
+
+function runScenario(scenario, verbose) {
+  var run = {
+    scenario: scenario,
+    verbose: verbose,
+    clock: createClock(START_TIME),
+    random: weatherServer.seededRandom(scenario.seed || 7),
+    server: weatherServer.createWeatherServer(scenario.server),
+    storage: createStorage(scenario.storage),
+    metrics: { gpsRequests: 0, gpsTimeouts: 0, messagesSent: 0, weatherMessages: 0, watchRequests: 0, restarts: 0 },
+    latencies: [],
+    pendingSince: null,
+    deliveredAt: null,
+    inFlight: 0           // GPS requests, API calls and messages not answered yet
+  };
+  var app = null;
+
+  // Weather fetched for the last known position can be followed by weather for
+  // the fix, so a sample runs to the last weather a trigger delivered and is
+  // only taken when the next trigger starts work (or the run ends)
+  function settle() {
+    if (run.pendingSince !== null && run.deliveredAt !== null) {
+      run.latencies.push(run.deliveredAt - run.pendingSince);
+    }
+    run.pendingSince = null;
+    run.deliveredAt = null;
+  }
+
+  // An error reported to the watch before any weather ends the wait, but isn't a sample
+  run.messageAcked = function(weather) {
+    if (run.pendingSince === null) {
+      return;
+    }
+    if (weather) {
+      run.deliveredAt = run.clock.now;
+    } else if (run.deliveredAt === null) {
+      run.pendingSince = null;
+    }
+  };
+
+  // Only triggers that start work count toward latency; a request answered
+  // with "weather is fresh" has nothing to wait for. The app's own refresh
+  // timers are triggers too
+  function work() {
+    return run.server.stats.calls + run.metrics.gpsRequests + run.metrics.messagesSent;
+  }
+  run.track = function(fn) {
+    return function() {
+      var before = work();
+      var started = run.clock.now;
+      var delivered = run.deliveredAt;
+      var waiting = run.inFlight > 0;
+      fn.apply(null, arguments);
+      if (work() > before) {
+        if (delivered !== null) {
+          settle();
+        } else if (!waiting) {
+          // The last trigger's work all failed; nothing can answer it any more
+          run.pendingSince = null;
+        }
+        if (run.pendingSince === null) {
+          run.pendingSince = started;
+        }
+      }
+    };
+  };
+
+  function trigger(type, event) {
+    run.track(function() {
+      app.dispatch(type, event);
+    })();
+  }
+
+  function start() {
+    if (app) {
+      run.clock.cancelOwner(app.generation);
+      run.metrics.restarts++;
+      // Whatever was in flight died with the old copy
+      settle();
+      run.inFlight = 0;
+    }
+    app = startApp(run, app ? app.generation + 1 : 1);
+    trigger('ready');
+  }
+
+  // The watch asks for weather on the hour and half hour (see tick_handler)
+  var events = [];
+  var firstRequest = Math.ceil((START_TIME + 1) / (30 * MINUTE)) * 30 * MINUTE - START_TIME;
+  range(firstRequest, scenario.durationMs, 30 * MINUTE).forEach(function(at) {
+    events.push({ at: at, fn: function() {
+      run.metrics.watchRequests++;
+      var payload = {};
+      payload[WEATHER_TEMPERATURE_KEY] = 1;
+      payload[WEATHER_REQUEST_STEPS_KEY] = scenario.stepsPerRequest || 400;
+      trigger('appmessage', { payload: payload });
+    } });
+  });
+  (scenario.restarts || []).forEach(function(at) {
+    events.push({ at: at, fn: start });
+  });
+  events.sort(function(a, b) { return a.at - b.at; });
+
+  start();
+  events.forEach(function(event) {
+    run.clock.runUntil(START_TIME + event.at);
+    event.fn();
+  });
+  run.clock.runUntil(START_TIME + scenario.durationMs);
+  settle();
+
+  return report(run);
+}
+
+function report(run) {
+  var sorted = run.latencies.slice().sort(function(a, b) { return a - b; });
+  function percentile(share) {
+    return sorted.length ? sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * share))] : null;
+  }
+  var quota = JSON.parse(run.storage.getItem('api-quota') || 'null');
+  return {
+    scenario: run.scenario.name,
+    hours: run.scenario.durationMs / HOUR,
+    restarts: run.metrics.restarts,
+    watchRequests: run.metrics.watchRequests,
+    api: run.server.stats,
+    apiTokensLeft: quota ? Math.round(quota.tokens * 10) / 10 : null,
+    gpsRequests: run.metrics.gpsRequests,
+    gpsTimeouts: run.metrics.gpsTimeouts,
+    messagesSent: run.metrics.messagesSent,
+    weatherMessages: run.metrics.weatherMessages,
+    latencyMs: {
+      samples: sorted.length,
+      mean: sorted.length ? Math.round(sorted.reduce(function(sum, ms) { return sum + ms; }, 0) / sorted.length) : null,
+      p50: percentile(0.5),
+      p90: percentile(0.9),
+      max: sorted.length ? sorted[sorted.length - 1] : null
+    }
+  };
+}
+
+function formatReport(result, description) {
+  var api = result.api;
+  var latency = result.latencyMs;
+  return [
+    result.scenario + ' (' + result.hours + ' h): ' + description,
+    '  API calls      ' + api.calls + ' (ok ' + api.ok + ', 429 ' + api.rateLimited + ', errors ' + api.errors +
+      ', dropped ' + api.dropped + ')' + (result.apiTokensLeft !== null ? ', ' + result.apiTokensLeft + ' tokens left' : ''),
+    '  GPS requests   ' + result.gpsRequests + ' (' + result.gpsTimeouts + ' timed out)',
+    '  Messages sent  ' + result.messagesSent + ' (' + result.weatherMessages + ' weather) for ' +
+      result.watchRequests + ' watch requests and ' + result.restarts + ' restarts',
+    '  End to end     ' + (latency.samples ?
+      latency.samples + ' samples, mean ' + latency.mean + ' ms, p50 ' + latency.p50 + ' ms, p90 ' + latency.p90 +
+      ' ms, max ' + latency.max + ' ms' : 'no weather delivered')
+  ].join('\n');
+}
+
+function main(argv) {
+  var verbose = argv.indexOf('-v') >= 0;
+  var json = argv.indexOf('--json') >= 0;
+  var names = argv.filter(function(arg) { return arg[0] !== '-'; });
+  var unknown = names.filter(function(name) {
+    return !SCENARIOS.some(function(scenario) { return scenario.name === name; });
+  });
+  if (unknown.length) {
+    console.error('unknown scenario: ' + unknown.join(', ') + '; have ' +
+                  SCENARIOS.map(function(scenario) { return scenario.name; }).join(', '));
+    process.exit(2);
+  }
+
+  var results = SCENARIOS.filter(function(scenario) {
+    return !names.length || names.indexOf(scenario.name) >= 0;
+  }).map(function(scenario) {
+    var result = runScenario(scenario, verbose);
+    if (!json) {
+      console.log(formatReport(result, scenario.description) + '\n');
+    }
+    return result;
+  });
+  if (json) {
+    console.log(JSON.stringify(results, null, 2));
+  }
+}
+
+module.exports = { runScenario: runScenario, SCENARIOS: SCENARIOS };
+
+if (require.main === module) {
+  main(process.argv.slice(2));
+}
@@ -0,0 +1,98 @@
+// Stand-in for the OpenWeatherMap forecast endpoint.
+//
+// The harness calls handle() directly on its virtual clock; run this file to
+// serve the same responses over HTTP for poking at by hand:
+//
+//   node weather_server.js [port]     then GET /data/2.5/forecast?lat=..&lon=..
+//
+// Forecast JSON is replayed from fixtures/ in turn. Latency, failures and the
+// daily call limit (answered with 429 like the real API) are configurable.
+'use strict';
+
+var fs = require('fs');
+var path = require('path');
+
+var FIXTURE_DIR = path.join(__dirname, 'fixtures');
+
+// Small deterministic generator so runs are repeatable
+function seededRandom(seed) {
+  var state = seed >>> 0 || 1;
+  return function() {
+    state ^= state << 13;
+    state ^= state >>> 17;
+    state ^= state << 5;
+    return (state >>> 0) / 4294967296;
+  };
+}
+
+function loadFixtures(names) {
+  return names.map(function(name) {
+    return fs.readFileSync(path.join(FIXTURE_DIR, name), 'utf8');
+  });
+}
+
+// options:
+//   fixtures      file names in fixtures/, replayed round robin
+//   latencyMs     [min, max] response time
+//   errorRate     share of requests answered with 500
+//   dropRate      share of requests that never connect (XHR onerror)
+//   dailyLimit    calls allowed before every request gets 429
+//   seed          for the random draws
+function createWeatherServer(options) {
+  options = options || {};
+  var fixtures = loadFixtures(options.fixtures || ['forecast_clear.json', 'forecast_rain.json']);
+  var latency = options.latencyMs || [150, 600];
+  var random = seededRandom(options.seed || 1);
+  var stats = { calls: 0, ok: 0, errors: 0, dropped: 0, rateLimited: 0 };
+  var next = 0;
+
+  function handle(url) {
+    stats.calls++;
+    var latencyMs = Math.round(latency[0] + random() * (latency[1] - latency[0]));
+
+    if (!/\/data\/2\.5\/forecast\?/.test(url) || !/[?&]lat=/.test(url) || !/[?&]lon=/.test(url)) {
+      stats.errors++;
+      return { status: 400, body: '{"cod":"400","message":"bad request"}', latencyMs: latencyMs };
+    }
+    if (options.dailyLimit !== undefined && stats.calls > options.dailyLimit) {
+      stats.rateLimited++;
+      return { status: 429, body: '{"cod":429,"message":"Your account is temporary blocked"}', latencyMs: latencyMs };
+    }
+    if (random() < (options.dropRate || 0)) {
+      stats.dropped++;
+      return { status: 0, body: '', latencyMs: latencyMs };
+    }
+    if (random() < (options.errorRate || 0)) {
+      stats.errors++;
+      return { status: 500, body: '{"cod":"500","message":"internal error"}', latencyMs: latencyMs };
+    }
+
+    stats.ok++;
+    var body = fixtures[next];
+    next = (next + 1) % fixtures.length;
+    return { status: 200, body: body, latencyMs: latencyMs };
+  }
+
+  return { handle: handle, stats: stats };
+}
+
+module.exports = { createWeatherServer: createWeatherServer, seededRandom: seededRandom };
+
+if (require.main === module) {
+  var http = require('http');
+  var port = parseInt(process.argv[2], 10) || 8080;
+  var server = createWeatherServer({ seed: Date.now() });
+  http.createServer(function(req, res) {
+    var reply = server.handle(req.url);
+    setTimeout(function() {
+      if (reply.status === 0) {
+        req.socket.destroy();
+        return;
+      }
+      res.writeHead(reply.status, { 'Content-Type': 'application/json' });
+      res.end(reply.body);
+    }, reply.latencyMs);
+  }).listen(port, function() {
+    console.log('Weather stand-in listening on http://localhost:' + port + '/data/2.5/forecast');
+  });
+}
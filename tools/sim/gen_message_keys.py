@@ -0,0 +1,35 @@
+#!/usr/bin/env python3
+"""Generate message_keys.auto.h from package.json the way the Pebble SDK does.
+
+Keys listed in pebble.messageKeys are numbered from 10000 in order; an entry
+like "Name[4]" reserves an array of keys.
+"""
+import json
+import re
+import sys
+
+FIRST_KEY = 10000
+
+
+def main(package_json, output):
+    with open(package_json) as f:
+        keys = json.load(f)['pebble'].get('messageKeys', [])
+
+    lines = ['#pragma once', '// Generated by gen_message_keys.py, do not edit', '']
+    next_key = FIRST_KEY
+    for entry in keys:
+        match = re.match(r'^(\w+)(?:\[(\d+)\])?$', entry)
+        if not match:
+            sys.exit('bad message key: {}'.format(entry))
+        name, count = match.group(1), int(match.group(2) or 1)
+        lines.append('#define MESSAGE_KEY_{} {}'.format(name, next_key))
+        next_key += count
+
+    with open(output, 'w') as f:
+        f.write('\n'.join(lines) + '\n')
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        sys.exit('usage: gen_message_keys.py package.json message_keys.auto.h')
+    main(sys.argv[1], sys.argv[2])
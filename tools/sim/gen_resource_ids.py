@@ -0,0 +1,31 @@
+#!/usr/bin/env python3
+"""Generate resource_ids.auto.h from package.json the way the Pebble SDK does.
+
+Media entries are numbered from 1 in order; an entry whose targetPlatforms
+leaves out the platform gets no ID there, so code using it fails to build.
+"""
+import json
+import sys
+
+
+def main(package_json, platform, output):
+    with open(package_json) as f:
+        media = json.load(f)['pebble'].get('resources', {}).get('media', [])
+
+    lines = ['#pragma once', '// Generated by gen_resource_ids.py, do not edit', '']
+    next_id = 1
+    for entry in media:
+        platforms = entry.get('targetPlatforms')
+        if platforms is not None and platform not in platforms:
+            continue
+        lines.append('#define RESOURCE_ID_{} {}'.format(entry['name'], next_id))
+        next_id += 1
+
+    with open(output, 'w') as f:
+        f.write('\n'.join(lines) + '\n')
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 4:
+        sys.exit('usage: gen_resource_ids.py package.json platform resource_ids.auto.h')
+    main(sys.argv[1], sys.argv[2], sys.argv[3])
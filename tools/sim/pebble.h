@@ -0,0 +1,470 @@
+// Mocked Pebble SDK for the host-side simulator.
+//
+// Declares just the parts of the SDK the watchface uses, with the same names
+// and signatures, so src/c/*.c compiles unchanged on Linux. Implementations
+// live in pebble_mock.c and count every call for the cost model.
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "message_keys.auto.h"
+#include "resource_ids.auto.h"
+
+// ============================================================================
+// PLATFORM
+// ============================================================================
+
+#if defined(SIM_PLATFORM_APLITE)
+#define PBL_PLATFORM_APLITE 1
+#define PBL_BW 1
+#define PBL_RECT 1
+#define PBL_DISPLAY_WIDTH 144
+#define PBL_DISPLAY_HEIGHT 168
+#elif defined(SIM_PLATFORM_CHALK)
+#define PBL_PLATFORM_CHALK 1
+#define PBL_COLOR 1
+#define PBL_ROUND 1
+#define PBL_HEALTH 1
+#define PBL_DISPLAY_WIDTH 180
+#define PBL_DISPLAY_HEIGHT 180
+#elif defined(SIM_PLATFORM_DIORITE)
+#define PBL_PLATFORM_DIORITE 1
+#define PBL_BW 1
+#define PBL_RECT 1
+#define PBL_HEALTH 1
+#define PBL_DISPLAY_WIDTH 144
+#define PBL_DISPLAY_HEIGHT 168
+#elif defined(SIM_PLATFORM_EMERY)
+#define PBL_PLATFORM_EMERY 1
+#define PBL_COLOR 1
+#define PBL_RECT 1
+#define PBL_HEALTH 1
+#define PBL_DISPLAY_WIDTH 200
+#define PBL_DISPLAY_HEIGHT 228
+#else
+#define PBL_PLATFORM_BASALT 1
+#define PBL_COLOR 1
+#define PBL_RECT 1
+#define PBL_HEALTH 1
+#define PBL_DISPLAY_WIDTH 144
+#define PBL_DISPLAY_HEIGHT 168
+#endif
+
+#if defined(PBL_ROUND)
+#define PBL_IF_ROUND_ELSE(if_true, if_false) (if_true)
+#define PBL_IF_RECT_ELSE(if_true, if_false) (if_false)
+#else
+#define PBL_IF_ROUND_ELSE(if_true, if_false) (if_false)
+#define PBL_IF_RECT_ELSE(if_true, if_false) (if_true)
+#endif
+
+#if defined(PBL_COLOR)
+#define PBL_IF_COLOR_ELSE(if_true, if_false) (if_true)
+#else
+#define PBL_IF_COLOR_ELSE(if_true, if_false) (if_false)
+#endif
+
+// The simulated clock replaces the host's
+time_t sim_time(time_t *tloc);
+#define time(tloc) sim_time(tloc)
+
+// ============================================================================
+// LOGGING
+// ============================================================================
+
+typedef enum {
+  APP_LOG_LEVEL_ERROR = 1,
+  APP_LOG_LEVEL_WARNING = 50,
+  APP_LOG_LEVEL_INFO = 100,
+  APP_LOG_LEVEL_DEBUG = 200,
+  APP_LOG_LEVEL_DEBUG_VERBOSE = 255,
+} AppLogLevel;
+
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...);
+#define APP_LOG(level, fmt, ...) app_log(level, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+
+// ============================================================================
+// MATH
+// ============================================================================
+
+#define TRIG_MAX_RATIO 0xffff
+#define TRIG_MAX_ANGLE 0x10000
+#define DEG_TO_TRIGANGLE(angle) (((angle) * TRIG_MAX_ANGLE) / 360)
+
+int32_t sin_lookup(int32_t angle);
+int32_t cos_lookup(int32_t angle);
+int32_t atan2_lookup(int16_t y, int16_t x);
+
+// ============================================================================
+// GRAPHICS TYPES
+// ============================================================================
+
+typedef struct { int16_t x, y; } GPoint;
+typedef struct { int16_t w, h; } GSize;
+typedef struct { GPoint origin; GSize size; } GRect;
+
+#define GPoint(x, y) ((GPoint){ (x), (y) })
+#define GSize(w, h) ((GSize){ (w), (h) })
+#define GRect(x, y, w, h) ((GRect){ { (x), (y) }, { (w), (h) } })
+
+typedef union { uint8_t argb; } GColor8;
+typedef GColor8 GColor;
+#define GColorBlack ((GColor8){ .argb = 0xc0 })
+#define GColorWhite ((GColor8){ .argb = 0xff })
+#define GColorClear ((GColor8){ .argb = 0x00 })
+
+typedef struct MockFont *GFont;
+typedef struct GContext GContext;
+typedef struct GBitmap GBitmap;
+
+typedef enum {
+  GTextOverflowModeWordWrap,
+  GTextOverflowModeTrailingEllipsis,
+  GTextOverflowModeFill,
+} GTextOverflowMode;
+
+typedef enum {
+  GTextAlignmentLeft,
+  GTextAlignmentCenter,
+  GTextAlignmentRight,
+} GTextAlignment;
+
+#define FONT_KEY_BITHAM_42_BOLD "RESOURCE_ID_BITHAM_42_BOLD"
+#define FONT_KEY_BITHAM_42_LIGHT "RESOURCE_ID_BITHAM_42_LIGHT"
+#define FONT_KEY_GOTHIC_18_BOLD "RESOURCE_ID_GOTHIC_18_BOLD"
+#define FONT_KEY_GOTHIC_18 "RESOURCE_ID_GOTHIC_18"
+
+GFont fonts_get_system_font(const char *font_key);
+GSize graphics_text_layout_get_content_size(const char *text, const GFont font, const GRect box,
+                                            const GTextOverflowMode overflow_mode,
+                                            const GTextAlignment alignment);
+
+#define GPointZero GPoint(0, 0)
+
+// ============================================================================
+// RESOURCES & DRAW COMMANDS
+// ============================================================================
+
+typedef struct GDrawCommandImage GDrawCommandImage;
+
+#if !defined(PBL_PLATFORM_APLITE)
+GDrawCommandImage *gdraw_command_image_create_with_resource(uint32_t resource_id);
+void gdraw_command_image_destroy(GDrawCommandImage *image);
+void gdraw_command_image_draw(GContext *ctx, GDrawCommandImage *image, GPoint offset);
+GSize gdraw_command_image_get_bounds_size(GDrawCommandImage *image);
+#endif
+
+// ============================================================================
+// LAYERS & WINDOWS
+// ============================================================================
+
+typedef struct Layer Layer;
+typedef struct TextLayer TextLayer;
+typedef struct Window Window;
+typedef void (*LayerUpdateProc)(Layer *layer, GContext *ctx);
+
+Layer *layer_create(GRect frame);
+void layer_destroy(Layer *layer);
+void layer_mark_dirty(Layer *layer);
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc);
+void layer_set_frame(Layer *layer, GRect frame);
+GRect layer_get_frame(const Layer *layer);
+GRect layer_get_bounds(const Layer *layer);
+void layer_add_child(Layer *parent, Layer *child);
+void layer_remove_from_parent(Layer *child);
+void layer_set_hidden(Layer *layer, bool hidden);
+bool layer_get_hidden(const Layer *layer);
+
+TextLayer *text_layer_create(GRect frame);
+void text_layer_destroy(TextLayer *text_layer);
+Layer *text_layer_get_layer(TextLayer *text_layer);
+void text_layer_set_text(TextLayer *text_layer, const char *text);
+const char *text_layer_get_text(TextLayer *text_layer);
+void text_layer_set_background_color(TextLayer *text_layer, GColor color);
+void text_layer_set_text_color(TextLayer *text_layer, GColor color);
+void text_layer_set_overflow_mode(TextLayer *text_layer, GTextOverflowMode line_mode);
+void text_layer_set_font(TextLayer *text_layer, GFont font);
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment text_alignment);
+
+typedef void (*WindowHandler)(Window *window);
+typedef struct {
+  WindowHandler load;
+  WindowHandler appear;
+  WindowHandler disappear;
+  WindowHandler unload;
+} WindowHandlers;
+
+Window *window_create(void);
+void window_destroy(Window *window);
+void window_set_window_handlers(Window *window, WindowHandlers handlers);
+void window_set_background_color(Window *window, GColor background_color);
+Layer *window_get_root_layer(const Window *window);
+void window_stack_push(Window *window, bool animated);
+
+// ============================================================================
+// ANIMATION
+// ============================================================================
+
+typedef struct Animation Animation;
+typedef struct PropertyAnimation PropertyAnimation;
+typedef uint32_t AnimationProgress;
+
+#define ANIMATION_NORMALIZED_MIN 0
+#define ANIMATION_NORMALIZED_MAX 65535
+#define ANIMATION_DURATION_INFINITE UINT32_MAX
+
+typedef enum {
+  AnimationCurveLinear,
+  AnimationCurveEaseIn,
+  AnimationCurveEaseOut,
+  AnimationCurveEaseInOut,
+} AnimationCurve;
+
+typedef void (*AnimationSetupImplementation)(Animation *animation);
+typedef void (*AnimationUpdateImplementation)(Animation *animation, const AnimationProgress progress);
+typedef void (*AnimationTeardownImplementation)(Animation *animation);
+
+typedef struct {
+  AnimationSetupImplementation setup;
+  AnimationUpdateImplementation update;
+  AnimationTeardownImplementation teardown;
+} AnimationImplementation;
+
+typedef void (*AnimationStartedHandler)(Animation *animation, void *context);
+typedef void (*AnimationStoppedHandler)(Animation *animation, bool finished, void *context);
+
+typedef struct {
+  AnimationStartedHandler started;
+  AnimationStoppedHandler stopped;
+} AnimationHandlers;
+
+Animation *animation_create(void);
+bool animation_destroy(Animation *animation);
+bool animation_set_implementation(Animation *animation, const AnimationImplementation *implementation);
+bool animation_set_handlers(Animation *animation, AnimationHandlers callbacks, void *context);
+void *animation_get_context(Animation *animation);
+bool animation_set_duration(Animation *animation, uint32_t duration_ms);
+bool animation_set_delay(Animation *animation, uint32_t delay_ms);
+bool animation_set_curve(Animation *animation, AnimationCurve curve);
+bool animation_schedule(Animation *animation);
+bool animation_unschedule(Animation *animation);
+bool animation_is_scheduled(Animation *animation);
+Animation *animation_sequence_create(Animation *animation_a, Animation *animation_b,
+                                     Animation *animation_c, ...);
+
+PropertyAnimation *property_animation_create_layer_frame(Layer *layer, GRect *from_frame, GRect *to_frame);
+Animation *property_animation_get_animation(PropertyAnimation *property_animation);
+
+// ============================================================================
+// TIMERS & SERVICES
+// ============================================================================
+
+typedef struct AppTimer AppTimer;
+typedef void (*AppTimerCallback)(void *data);
+
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data);
+bool app_timer_reschedule(AppTimer *timer_handle, uint32_t new_timeout_ms);
+void app_timer_cancel(AppTimer *timer_handle);
+
+typedef enum {
+  SECOND_UNIT = 1 << 0,
+  MINUTE_UNIT = 1 << 1,
+  HOUR_UNIT = 1 << 2,
+  DAY_UNIT = 1 << 3,
+  MONTH_UNIT = 1 << 4,
+  YEAR_UNIT = 1 << 5,
+} TimeUnits;
+
+typedef void (*TickHandler)(struct tm *tick_time, TimeUnits units_changed);
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler);
+void tick_timer_service_unsubscribe(void);
+
+typedef enum {
+  ACCEL_AXIS_X = 0,
+  ACCEL_AXIS_Y = 1,
+  ACCEL_AXIS_Z = 2,
+} AccelAxisType;
+
+typedef void (*AccelTapHandler)(AccelAxisType axis, int32_t direction);
+void accel_tap_service_subscribe(AccelTapHandler handler);
+void accel_tap_service_unsubscribe(void);
+
+uint16_t time_ms(time_t *t_utc, uint16_t *out_ms);
+time_t time_start_of_today(void);
+
+typedef struct {
+  uint8_t charge_percent;
+  bool is_charging;
+  bool is_plugged;
+} BatteryChargeState;
+
+typedef void (*BatteryStateHandler)(BatteryChargeState charge);
+void battery_state_service_subscribe(BatteryStateHandler handler);
+void battery_state_service_unsubscribe(void);
+BatteryChargeState battery_state_service_peek(void);
+
+typedef enum {
+  HealthEventSignificantUpdate = 0,
+  HealthEventMovementUpdate,
+  HealthEventSleepUpdate,
+  HealthEventMetricAlert,
+  HealthEventHeartRateUpdate,
+} HealthEventType;
+
+typedef enum {
+  HealthMetricStepCount,
+  HealthMetricActiveSeconds,
+  HealthMetricWalkedDistanceMeters,
+  HealthMetricSleepSeconds,
+  HealthMetricSleepRestfulSeconds,
+  HealthMetricRestingKCalories,
+  HealthMetricActiveKCalories,
+  HealthMetricHeartRateBPM,
+  HealthMetricHeartRateRawBPM,
+} HealthMetric;
+
+typedef int32_t HealthValue;
+
+typedef enum {
+  HealthServiceAccessibilityMaskAvailable = 1 << 0,
+  HealthServiceAccessibilityMaskNoPermission = 1 << 1,
+  HealthServiceAccessibilityMaskNotSupported = 1 << 2,
+  HealthServiceAccessibilityMaskNotAvailable = 1 << 3,
+} HealthServiceAccessibilityMask;
+
+typedef void (*HealthEventHandler)(HealthEventType event, void *context);
+bool health_service_events_subscribe(HealthEventHandler handler, void *context);
+bool health_service_events_unsubscribe(void);
+HealthServiceAccessibilityMask health_service_metric_accessible(HealthMetric metric, time_t time_start, time_t time_end);
+HealthValue health_service_sum_today(HealthMetric metric);
+HealthValue health_service_peek_current_value(HealthMetric metric);
+bool health_service_set_heart_rate_sample_period(uint16_t interval_sec);
+uint32_t health_service_get_heart_rate_sample_period_expiration_sec(void);
+
+typedef void (*AppFocusHandler)(bool in_focus);
+void app_focus_service_subscribe(AppFocusHandler handler);
+void app_focus_service_unsubscribe(void);
+
+// ============================================================================
+// APP WORKER
+// ============================================================================
+
+// The simulator runs no worker, so the watchface takes its own health path
+typedef struct {
+  uint16_t data0;
+  uint16_t data1;
+  uint16_t data2;
+} AppWorkerMessage;
+
+typedef enum {
+  APP_WORKER_RESULT_SUCCESS = 0,
+  APP_WORKER_RESULT_NO_WORKER = 1,
+  APP_WORKER_RESULT_DIFFERENT_APP = 2,
+  APP_WORKER_RESULT_NOT_RUNNING = 3,
+  APP_WORKER_RESULT_ALREADY_RUNNING = 4,
+  APP_WORKER_RESULT_ASKING_CONFIRMATION = 5,
+} AppWorkerResult;
+
+typedef void (*AppWorkerMessageHandler)(uint16_t type, AppWorkerMessage *data);
+bool app_worker_is_running(void);
+AppWorkerResult app_worker_launch(void);
+AppWorkerResult app_worker_kill(void);
+bool app_worker_message_subscribe(AppWorkerMessageHandler handler);
+bool app_worker_message_unsubscribe(void);
+void app_worker_send_message(uint8_t type, AppWorkerMessage *data);
+
+// ============================================================================
+// APP MESSAGE & DICTIONARY
+// ============================================================================
+
+typedef enum {
+  TUPLE_BYTE_ARRAY = 0,
+  TUPLE_CSTRING = 1,
+  TUPLE_UINT = 2,
+  TUPLE_INT = 3,
+} TupleType;
+
+typedef struct __attribute__((packed)) {
+  uint32_t key;
+  TupleType type:8;
+  uint16_t length;
+  union {
+    uint8_t data[0];
+    char cstring[0];
+    uint8_t uint8;
+    uint16_t uint16;
+    uint32_t uint32;
+    int8_t int8;
+    int16_t int16;
+    int32_t int32;
+  } value[];
+} Tuple;
+
+typedef struct DictionaryIterator DictionaryIterator;
+
+typedef enum {
+  DICT_OK = 0,
+  DICT_NOT_ENOUGH_STORAGE = 1 << 1,
+  DICT_INVALID_ARGS = 1 << 2,
+} DictionaryResult;
+
+Tuple *dict_find(const DictionaryIterator *iter, const uint32_t key);
+DictionaryResult dict_write_data(DictionaryIterator *iter, const uint32_t key, const uint8_t *data, const uint16_t size);
+DictionaryResult dict_write_cstring(DictionaryIterator *iter, const uint32_t key, const char *cstring);
+DictionaryResult dict_write_int(DictionaryIterator *iter, const uint32_t key, const void *integer, const uint8_t width_bytes, const bool is_signed);
+DictionaryResult dict_write_uint8(DictionaryIterator *iter, const uint32_t key, const uint8_t value);
+DictionaryResult dict_write_uint16(DictionaryIterator *iter, const uint32_t key, const uint16_t value);
+DictionaryResult dict_write_uint32(DictionaryIterator *iter, const uint32_t key, const uint32_t value);
+DictionaryResult dict_write_int32(DictionaryIterator *iter, const uint32_t key, const int32_t value);
+uint32_t dict_write_end(DictionaryIterator *iter);
+
+typedef enum {
+  APP_MSG_OK = 0,
+  APP_MSG_SEND_TIMEOUT = 1 << 1,
+  APP_MSG_BUSY = 1 << 6,
+  APP_MSG_BUFFER_OVERFLOW = 1 << 7,
+} AppMessageResult;
+
+typedef void (*AppMessageInboxReceived)(DictionaryIterator *iterator, void *context);
+typedef void (*AppMessageInboxDropped)(AppMessageResult reason, void *context);
+typedef void (*AppMessageOutboxSent)(DictionaryIterator *iterator, void *context);
+typedef void (*AppMessageOutboxFailed)(DictionaryIterator *iterator, AppMessageResult reason, void *context);
+
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound);
+AppMessageInboxReceived app_message_register_inbox_received(AppMessageInboxReceived received_callback);
+AppMessageInboxDropped app_message_register_inbox_dropped(AppMessageInboxDropped dropped_callback);
+AppMessageOutboxSent app_message_register_outbox_sent(AppMessageOutboxSent sent_callback);
+AppMessageOutboxFailed app_message_register_outbox_failed(AppMessageOutboxFailed failed_callback);
+AppMessageResult app_message_outbox_begin(DictionaryIterator **iterator);
+AppMessageResult app_message_outbox_send(void);
+
+// ============================================================================
+// PERSISTENT STORAGE
+// ============================================================================
+
+#define PERSIST_DATA_MAX_LENGTH 256
+#define PERSIST_STRING_MAX_LENGTH PERSIST_DATA_MAX_LENGTH
+
+bool persist_exists(const uint32_t key);
+int persist_get_size(const uint32_t key);
+int32_t persist_read_int(const uint32_t key);
+bool persist_read_bool(const uint32_t key);
+int persist_read_data(const uint32_t key, void *buffer, const size_t buffer_size);
+int persist_read_string(const uint32_t key, char *buffer, const size_t buffer_size);
+int persist_write_int(const uint32_t key, const int32_t value);
+int persist_write_bool(const uint32_t key, const bool value);
+int persist_write_data(const uint32_t key, const void *data, const size_t size);
+int persist_write_string(const uint32_t key, const char *cstring);
+int persist_delete(const uint32_t key);
+
+// ============================================================================
+// APP LIFECYCLE
+// ============================================================================
+
+void app_event_loop(void);
@@ -0,0 +1,1353 @@
+// Mocked Pebble API with a discrete-event loop.
+//
+// app_event_loop() runs the whole simulation: minute ticks, app timers,
+// animation frames, AppMessage traffic and the scripted health, battery and
+// weather events are dispatched in simulated time, and every API call is
+// counted so the driver can price a day of running the watchface.
+#include "sim.h"
+
+#include <math.h>
+#include <stdarg.h>
+
+#define ANIMATION_FRAME_MS 33
+#define OUTBOX_ACK_MS 120
+#define MAX_TIMERS 32
+#define MAX_ANIMATIONS 64
+#define MAX_SEQUENCE 8
+#define MAX_PERSIST_KEYS 64
+#define MAX_INTERNAL 16
+#define MAX_API_NAMES 128
+#define DICT_BUFFER_SIZE 1024
+
+static SimConfig s_config;
+static int64_t s_now_ms;
+static bool s_dirty;
+
+// ============================================================================
+// COUNTERS
+// ============================================================================
+
+static uint64_t s_counters[SIM_COUNTER_COUNT];
+
+static const char *s_counter_names[SIM_COUNTER_COUNT] = {
+  [SIM_COUNTER_WAKEUP] = "wakeup",
+  [SIM_COUNTER_TICK] = "tick",
+  [SIM_COUNTER_TIMER_FIRE] = "timer_fire",
+  [SIM_COUNTER_ANIMATION_FRAME] = "animation_frame",
+  [SIM_COUNTER_DISPLAY_REFRESH] = "display_refresh",
+  [SIM_COUNTER_TEXT_LAYOUT] = "text_layout",
+  [SIM_COUNTER_TEXT_SET] = "text_set",
+  [SIM_COUNTER_LAYER_MOVE] = "layer_move",
+  [SIM_COUNTER_PERSIST_WRITE] = "persist_write",
+  [SIM_COUNTER_PERSIST_BYTES] = "persist_bytes",
+  [SIM_COUNTER_MESSAGE_OUT] = "message_out",
+  [SIM_COUNTER_MESSAGE_IN] = "message_in",
+  [SIM_COUNTER_MESSAGE_BYTES] = "message_bytes",
+  [SIM_COUNTER_HEALTH_READ] = "health_read",
+  [SIM_COUNTER_HRM_SAMPLE] = "hrm_sample",
+};
+
+static struct {
+  const char *name;
+  uint64_t calls;
+} s_api[MAX_API_NAMES];
+static int s_api_count;
+
+static void count_api(const char *name) {
+  for (int i = 0; i < s_api_count; i++) {
+    if (s_api[i].name == name || strcmp(s_api[i].name, name) == 0) {
+      s_api[i].calls++;
+      return;
+    }
+  }
+  if (s_api_count < MAX_API_NAMES) {
+    s_api[s_api_count].name = name;
+    s_api[s_api_count].calls = 1;
+    s_api_count++;
+  }
+}
+
+#define API() count_api(__func__)
+
+uint64_t sim_counter(SimCounter counter) { return s_counters[counter]; }
+const char *sim_counter_name(SimCounter counter) { return s_counter_names[counter]; }
+int sim_api_count(void) { return s_api_count; }
+const char *sim_api_name(int index) { return s_api[index].name; }
+uint64_t sim_api_calls(int index) { return s_api[index].calls; }
+int64_t sim_now_ms(void) { return s_now_ms; }
+
+void sim_configure(const SimConfig *config) {
+  s_config = *config;
+}
+
+// ============================================================================
+// TIME & LOGGING
+// ============================================================================
+
+time_t sim_time(time_t *tloc) {
+  time_t now = s_config.start + (time_t)(s_now_ms / 1000);
+  if (tloc) *tloc = now;
+  return now;
+}
+
+uint16_t time_ms(time_t *t_utc, uint16_t *out_ms) {
+  API();
+  uint16_t ms = (uint16_t)(s_now_ms % 1000);
+  if (t_utc) *t_utc = sim_time(NULL);
+  if (out_ms) *out_ms = ms;
+  return ms;
+}
+
+time_t time_start_of_today(void) {
+  API();
+  time_t now = sim_time(NULL);
+  struct tm t = *localtime(&now);
+  t.tm_hour = 0;
+  t.tm_min = 0;
+  t.tm_sec = 0;
+  return mktime(&t);
+}
+
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...) {
+  (void) log_level;
+  if (!s_config.verbose) return;
+  time_t now = sim_time(NULL);
+  struct tm t = *localtime(&now);
+  fprintf(stderr, "[%02d:%02d:%02d.%03d] %s:%d ", t.tm_hour, t.tm_min, t.tm_sec,
+          (int)(s_now_ms % 1000), src_filename, src_line_number);
+  va_list args;
+  va_start(args, fmt);
+  vfprintf(stderr, fmt, args);
+  va_end(args);
+  fputc('\n', stderr);
+}
+
+// ============================================================================
+// MATH
+// ============================================================================
+
+int32_t sin_lookup(int32_t angle) {
+  API();
+  return (int32_t)lround(sin(angle * 2 * M_PI / TRIG_MAX_ANGLE) * TRIG_MAX_RATIO);
+}
+
+int32_t cos_lookup(int32_t angle) {
+  API();
+  return (int32_t)lround(cos(angle * 2 * M_PI / TRIG_MAX_ANGLE) * TRIG_MAX_RATIO);
+}
+
+int32_t atan2_lookup(int16_t y, int16_t x) {
+  API();
+  double angle = atan2(y, x);
+  if (angle < 0) angle += 2 * M_PI;
+  return (int32_t)lround(angle * TRIG_MAX_ANGLE / (2 * M_PI)) % TRIG_MAX_ANGLE;
+}
+
+// ============================================================================
+// GRAPHICS, LAYERS & WINDOWS
+// ============================================================================
+
+struct MockFont {
+  const char *key;
+  int advance;
+  int height;
+};
+
+static struct MockFont s_fonts[] = {
+  { FONT_KEY_BITHAM_42_BOLD, 24, 42 },
+  { FONT_KEY_BITHAM_42_LIGHT, 22, 42 },
+  { FONT_KEY_GOTHIC_18_BOLD, 9, 18 },
+  { FONT_KEY_GOTHIC_18, 8, 18 },
+};
+
+GFont fonts_get_system_font(const char *font_key) {
+  API();
+  for (size_t i = 0; i < sizeof(s_fonts) / sizeof(s_fonts[0]); i++) {
+    if (strcmp(s_fonts[i].key, font_key) == 0) return &s_fonts[i];
+  }
+  return &s_fonts[0];
+}
+
+// Narrow and wide glyph classes so width-dependent code paths get exercised
+static int glyph_advance(GFont font, char c) {
+  if (strchr("ijlt'f r.", c)) return font->advance / 2;
+  if (strchr("mw%", c)) return font->advance * 3 / 2;
+  return font->advance;
+}
+
+GSize graphics_text_layout_get_content_size(const char *text, const GFont font, const GRect box,
+                                            const GTextOverflowMode overflow_mode,
+                                            const GTextAlignment alignment) {
+  (void) overflow_mode;
+  (void) alignment;
+  API();
+  s_counters[SIM_COUNTER_TEXT_LAYOUT]++;
+  int width = 0;
+  size_t len = strlen(text);
+  // Trailing whitespace does not contribute to the content size
+  while (len > 0 && text[len - 1] == ' ') len--;
+  for (size_t i = 0; i < len; i++) width += glyph_advance(font, text[i]);
+  if (width > box.size.w) width = box.size.w;
+  return GSize(width, len ? font->height : 0);
+}
+
+struct Layer {
+  GRect frame;
+  bool hidden;
+  LayerUpdateProc update_proc;
+  Layer *parent;
+};
+
+struct TextLayer {
+  Layer layer;
+  const char *text;
+  GFont font;
+};
+
+struct Window {
+  Layer root;
+  WindowHandlers handlers;
+};
+
+Layer *layer_create(GRect frame) {
+  API();
+  Layer *layer = calloc(1, sizeof(Layer));
+  layer->frame = frame;
+  return layer;
+}
+
+void layer_destroy(Layer *layer) {
+  API();
+  free(layer);
+}
+
+void layer_mark_dirty(Layer *layer) {
+  (void) layer;
+  API();
+  s_dirty = true;
+}
+
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc) {
+  API();
+  layer->update_proc = update_proc;
+}
+
+void layer_set_frame(Layer *layer, GRect frame) {
+  API();
+  s_counters[SIM_COUNTER_LAYER_MOVE]++;
+  if (memcmp(&layer->frame, &frame, sizeof(frame)) != 0) s_dirty = true;
+  layer->frame = frame;
+}
+
+GRect layer_get_frame(const Layer *layer) {
+  API();
+  return layer->frame;
+}
+
+GRect layer_get_bounds(const Layer *layer) {
+  API();
+  return GRect(0, 0, layer->frame.size.w, layer->frame.size.h);
+}
+
+void layer_add_child(Layer *parent, Layer *child) {
+  API();
+  child->parent = parent;
+  s_dirty = true;
+}
+
+void layer_remove_from_parent(Layer *child) {
+  API();
+  child->parent = NULL;
+  s_dirty = true;
+}
+
+void layer_set_hidden(Layer *layer, bool hidden) {
+  API();
+  if (layer->hidden != hidden) s_dirty = true;
+  layer->hidden = hidden;
+}
+
+bool layer_get_hidden(const Layer *layer) {
+  API();
+  return layer->hidden;
+}
+
+// Resources aren't read from disk; an image is as big as the weather icons are
+struct GDrawCommandImage {
+  uint32_t resource_id;
+  GSize size;
+};
+
+#if !defined(PBL_PLATFORM_APLITE)
+GDrawCommandImage *gdraw_command_image_create_with_resource(uint32_t resource_id) {
+  API();
+  GDrawCommandImage *image = calloc(1, sizeof(GDrawCommandImage));
+  image->resource_id = resource_id;
+  image->size = GSize(18, 18);
+  return image;
+}
+
+void gdraw_command_image_destroy(GDrawCommandImage *image) {
+  API();
+  free(image);
+}
+
+void gdraw_command_image_draw(GContext *ctx, GDrawCommandImage *image, GPoint offset) {
+  (void) ctx;
+  (void) image;
+  (void) offset;
+  API();
+}
+
+GSize gdraw_command_image_get_bounds_size(GDrawCommandImage *image) {
+  API();
+  return image->size;
+}
+#endif
+
+TextLayer *text_layer_create(GRect frame) {
+  API();
+  TextLayer *text_layer = calloc(1, sizeof(TextLayer));
+  text_layer->layer.frame = frame;
+  return text_layer;
+}
+
+void text_layer_destroy(TextLayer *text_layer) {
+  API();
+  free(text_layer);
+}
+
+Layer *text_layer_get_layer(TextLayer *text_layer) {
+  API();
+  return &text_layer->layer;
+}
+
+void text_layer_set_text(TextLayer *text_layer, const char *text) {
+  API();
+  s_counters[SIM_COUNTER_TEXT_SET]++;
+  text_layer->text = text;
+  s_dirty = true;
+}
+
+const char *text_layer_get_text(TextLayer *text_layer) {
+  API();
+  return text_layer->text;
+}
+
+void text_layer_set_background_color(TextLayer *text_layer, GColor color) { (void) text_layer; (void) color; API(); }
+void text_layer_set_text_color(TextLayer *text_layer, GColor color) { (void) text_layer; (void) color; API(); }
+void text_layer_set_overflow_mode(TextLayer *text_layer, GTextOverflowMode line_mode) { (void) text_layer; (void) line_mode; API(); }
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment text_alignment) { (void) text_layer; (void) text_alignment; API(); }
+
+void text_layer_set_font(TextLayer *text_layer, GFont font) {
+  API();
+  text_layer->font = font;
+}
+
+static Window *s_top_window;
+
+Window *window_create(void) {
+  API();
+  Window *window = calloc(1, sizeof(Window));
+  window->root.frame = GRect(0, 0, PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT);
+  return window;
+}
+
+void window_destroy(Window *window) {
+  API();
+  if (s_top_window == window) s_top_window = NULL;
+  free(window);
+}
+
+void window_set_window_handlers(Window *window, WindowHandlers handlers) {
+  API();
+  window->handlers = handlers;
+}
+
+void window_set_background_color(Window *window, GColor background_color) { (void) window; (void) background_color; API(); }
+
+Layer *window_get_root_layer(const Window *window) {
+  API();
+  return (Layer *)&window->root;
+}
+
+void window_stack_push(Window *window, bool animated) {
+  (void) animated;
+  API();
+  s_top_window = window;
+  if (window->handlers.load) window->handlers.load(window);
+  // The appear handler runs once the event loop starts, after the push transition
+}
+
+// ============================================================================
+// ANIMATION
+// ============================================================================
+
+struct Animation {
+  AnimationImplementation implementation;
+  AnimationHandlers handlers;
+  void *context;
+  uint32_t duration_ms, delay_ms;
+  AnimationCurve curve;
+  bool scheduled, started, finished, dead;
+  int64_t scheduled_at_ms;
+  // Property animation
+  bool is_property;
+  Layer *layer;
+  GRect from, to;
+  // Sequence
+  Animation *children[MAX_SEQUENCE];
+  int child_count;
+};
+
+struct PropertyAnimation {
+  Animation animation;  // first, so the two pointers convert
+};
+
+static Animation *s_scheduled[MAX_ANIMATIONS];
+static int s_scheduled_count;
+static Animation *s_graveyard[MAX_ANIMATIONS * 2];
+static int s_graveyard_count;
+static int64_t s_next_frame_ms = -1;
+
+static void bury(Animation *animation) {
+  if (animation->dead) return;
+  animation->dead = true;
+  animation->scheduled = false;
+  for (int i = 0; i < animation->child_count; i++) bury(animation->children[i]);
+  if (s_graveyard_count < (int)(sizeof(s_graveyard) / sizeof(s_graveyard[0]))) {
+    s_graveyard[s_graveyard_count++] = animation;
+  }
+}
+
+// Freed between frames so handlers can still compare stale pointers safely
+static void empty_graveyard(void) {
+  for (int i = 0; i < s_graveyard_count; i++) free(s_graveyard[i]);
+  s_graveyard_count = 0;
+}
+
+static void remove_scheduled(Animation *animation) {
+  for (int i = 0; i < s_scheduled_count; i++) {
+    if (s_scheduled[i] == animation) {
+      s_scheduled[i] = s_scheduled[--s_scheduled_count];
+      return;
+    }
+  }
+}
+
+Animation *animation_create(void) {
+  API();
+  return calloc(1, sizeof(Animation));
+}
+
+bool animation_destroy(Animation *animation) {
+  API();
+  if (!animation || animation->dead) return false;
+  remove_scheduled(animation);
+  bury(animation);
+  return true;
+}
+
+bool animation_set_implementation(Animation *animation, const AnimationImplementation *implementation) {
+  API();
+  animation->implementation = *implementation;
+  return true;
+}
+
+bool animation_set_handlers(Animation *animation, AnimationHandlers callbacks, void *context) {
+  API();
+  animation->handlers = callbacks;
+  animation->context = context;
+  return true;
+}
+
+void *animation_get_context(Animation *animation) {
+  API();
+  return animation->context;
+}
+
+bool animation_set_duration(Animation *animation, uint32_t duration_ms) {
+  API();
+  animation->duration_ms = duration_ms;
+  return true;
+}
+
+bool animation_set_delay(Animation *animation, uint32_t delay_ms) {
+  API();
+  animation->delay_ms = delay_ms;
+  return true;
+}
+
+bool animation_set_curve(Animation *animation, AnimationCurve curve) {
+  API();
+  animation->curve = curve;
+  return true;
+}
+
+static uint32_t total_duration(const Animation *animation) {
+  if (animation->child_count == 0) return animation->duration_ms;
+  uint32_t total = 0;
+  for (int i = 0; i < animation->child_count; i++) {
+    total += animation->children[i]->delay_ms + total_duration(animation->children[i]);
+  }
+  return total;
+}
+
+bool animation_schedule(Animation *animation) {
+  API();
+  if (!animation || animation->dead || animation->scheduled) return false;
+  if (s_scheduled_count >= MAX_ANIMATIONS) return false;
+  animation->scheduled = true;
+  animation->scheduled_at_ms = s_now_ms;
+  s_scheduled[s_scheduled_count++] = animation;
+  if (s_next_frame_ms < 0) s_next_frame_ms = s_now_ms + ANIMATION_FRAME_MS;
+  return true;
+}
+
+static void stop_animation(Animation *animation, bool finished) {
+  for (int i = 0; i < animation->child_count; i++) {
+    Animation *child = animation->children[i];
+    if (child->started && !child->finished) stop_animation(child, finished);
+  }
+  animation->finished = true;
+  if (animation->implementation.teardown) animation->implementation.teardown(animation);
+  if (animation->handlers.stopped) animation->handlers.stopped(animation, finished, animation->context);
+}
+
+bool animation_unschedule(Animation *animation) {
+  API();
+  if (!animation || animation->dead || !animation->scheduled) return false;
+  remove_scheduled(animation);
+  animation->scheduled = false;
+  stop_animation(animation, false);
+  bury(animation);
+  return true;
+}
+
+bool animation_is_scheduled(Animation *animation) {
+  API();
+  return animation && !animation->dead && animation->scheduled;
+}
+
+Animation *animation_sequence_create(Animation *animation_a, Animation *animation_b,
+                                     Animation *animation_c, ...) {
+  API();
+  Animation *sequence = calloc(1, sizeof(Animation));
+  Animation *first[] = { animation_a, animation_b, animation_c };
+  for (int i = 0; i < 3 && first[i]; i++) sequence->children[sequence->child_count++] = first[i];
+  if (animation_a && animation_b && animation_c) {
+    va_list args;
+    va_start(args, animation_c);
+    Animation *next;
+    while ((next = va_arg(args, Animation *)) && sequence->child_count < MAX_SEQUENCE) {
+      sequence->children[sequence->child_count++] = next;
+    }
+    va_end(args);
+  }
+  return sequence;
+}
+
+PropertyAnimation *property_animation_create_layer_frame(Layer *layer, GRect *from_frame, GRect *to_frame) {
+  API();
+  PropertyAnimation *property = calloc(1, sizeof(PropertyAnimation));
+  property->animation.is_property = true;
+  property->animation.layer = layer;
+  property->animation.from = from_frame ? *from_frame : layer->frame;
+  property->animation.to = to_frame ? *to_frame : layer->frame;
+  property->animation.duration_ms = 250;
+  return property;
+}
+
+Animation *property_animation_get_animation(PropertyAnimation *property_animation) {
+  API();
+  return &property_animation->animation;
+}
+
+static int16_t lerp(int16_t from, int16_t to, AnimationProgress progress) {
+  return from + (int16_t)(((int32_t)(to - from) * (int32_t)progress) / ANIMATION_NORMALIZED_MAX);
+}
+
+static void apply_progress(Animation *animation, AnimationProgress progress) {
+  if (animation->is_property) {
+    GRect frame = {
+      { lerp(animation->from.origin.x, animation->to.origin.x, progress),
+        lerp(animation->from.origin.y, animation->to.origin.y, progress) },
+      { lerp(animation->from.size.w, animation->to.size.w, progress),
+        lerp(animation->from.size.h, animation->to.size.h, progress) }
+    };
+    layer_set_frame(animation->layer, frame);
+  } else if (animation->implementation.update) {
+    animation->implementation.update(animation, progress);
+  }
+}
+
+// Drive an animation to `elapsed` ms past its own delay; returns true when done
+static bool advance_animation(Animation *animation, int64_t elapsed) {
+  if (!animation->started) {
+    animation->started = true;
+    if (animation->implementation.setup) animation->implementation.setup(animation);
+    if (animation->handlers.started) animation->handlers.started(animation, animation->context);
+  }
+
+  if (animation->child_count == 0) {
+    uint32_t duration = animation->duration_ms;
+    AnimationProgress progress = (duration == 0 || elapsed >= duration) ? ANIMATION_NORMALIZED_MAX :
+                                 (AnimationProgress)(elapsed * ANIMATION_NORMALIZED_MAX / duration);
+    apply_progress(animation, progress);
+    return elapsed >= duration;
+  }
+
+  int64_t offset = 0;
+  for (int i = 0; i < animation->child_count; i++) {
+    Animation *child = animation->children[i];
+    int64_t child_start = offset + child->delay_ms;
+    int64_t child_end = child_start + total_duration(child);
+    if (elapsed >= child_start && !child->finished) {
+      if (advance_animation(child, elapsed - child_start) || elapsed >= child_end) {
+        stop_animation(child, true);
+      }
+    }
+    offset = child_end;
+  }
+  return elapsed >= offset;
+}
+
+static void run_animation_frame(void) {
+  Animation *frame[MAX_ANIMATIONS];
+  int count = s_scheduled_count;
+  memcpy(frame, s_scheduled, count * sizeof(Animation *));
+
+  bool updated = false;
+  for (int i = 0; i < count; i++) {
+    Animation *animation = frame[i];
+    if (animation->dead || !animation->scheduled) continue;
+    int64_t elapsed = s_now_ms - animation->scheduled_at_ms - animation->delay_ms;
+    if (elapsed < 0) continue;
+    updated = true;
+    if (advance_animation(animation, elapsed)) {
+      remove_scheduled(animation);
+      animation->scheduled = false;
+      stop_animation(animation, true);
+      bury(animation);
+    }
+  }
+
+  if (updated) {
+    s_counters[SIM_COUNTER_ANIMATION_FRAME]++;
+    s_counters[SIM_COUNTER_WAKEUP]++;
+  }
+  empty_graveyard();
+  s_next_frame_ms = s_scheduled_count > 0 ? s_now_ms + ANIMATION_FRAME_MS : -1;
+}
+
+// ============================================================================
+// TIMERS
+// ============================================================================
+
+struct AppTimer {
+  int64_t fire_ms;
+  AppTimerCallback callback;
+  void *data;
+};
+
+static AppTimer *s_timers[MAX_TIMERS];
+static int s_timer_count;
+
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data) {
+  API();
+  if (s_timer_count >= MAX_TIMERS) return NULL;
+  AppTimer *timer = calloc(1, sizeof(AppTimer));
+  timer->fire_ms = s_now_ms + timeout_ms;
+  timer->callback = callback;
+  timer->data = callback_data;
+  s_timers[s_timer_count++] = timer;
+  return timer;
+}
+
+static bool remove_timer(AppTimer *timer) {
+  for (int i = 0; i < s_timer_count; i++) {
+    if (s_timers[i] == timer) {
+      s_timers[i] = s_timers[--s_timer_count];
+      return true;
+    }
+  }
+  return false;
+}
+
+bool app_timer_reschedule(AppTimer *timer_handle, uint32_t new_timeout_ms) {
+  API();
+  for (int i = 0; i < s_timer_count; i++) {
+    if (s_timers[i] == timer_handle) {
+      timer_handle->fire_ms = s_now_ms + new_timeout_ms;
+      return true;
+    }
+  }
+  return false;
+}
+
+void app_timer_cancel(AppTimer *timer_handle) {
+  API();
+  if (remove_timer(timer_handle)) free(timer_handle);
+}
+
+static AppTimer *next_timer(void) {
+  AppTimer *next = NULL;
+  for (int i = 0; i < s_timer_count; i++) {
+    if (!next || s_timers[i]->fire_ms < next->fire_ms) next = s_timers[i];
+  }
+  return next;
+}
+
+// ============================================================================
+// TICK, BATTERY & HEALTH SERVICES
+// ============================================================================
+
+static TickHandler s_tick_handler;
+static TimeUnits s_tick_units;
+static int64_t s_next_tick_ms = -1;
+
+static int64_t tick_period_ms(TimeUnits units) {
+  if (units & SECOND_UNIT) return 1000;
+  if (units & MINUTE_UNIT) return 60 * 1000;
+  if (units & HOUR_UNIT) return 60 * 60 * 1000;
+  return 24 * 60 * 60 * 1000;
+}
+
+static void schedule_next_tick(void) {
+  if (!s_tick_handler) {
+    s_next_tick_ms = -1;
+    return;
+  }
+  // Ticks land on wall-clock boundaries, not on multiples of the start offset
+  int64_t period = tick_period_ms(s_tick_units);
+  int64_t wall_ms = (int64_t)s_config.start * 1000 + s_now_ms;
+  s_next_tick_ms = (wall_ms / period + 1) * period - (int64_t)s_config.start * 1000;
+}
+
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler) {
+  API();
+  s_tick_units = tick_units;
+  s_tick_handler = handler;
+  schedule_next_tick();
+}
+
+void tick_timer_service_unsubscribe(void) {
+  API();
+  s_tick_handler = NULL;
+  s_next_tick_ms = -1;
+}
+
+static AccelTapHandler s_tap_handler;
+
+void accel_tap_service_subscribe(AccelTapHandler handler) {
+  API();
+  s_tap_handler = handler;
+}
+
+void accel_tap_service_unsubscribe(void) {
+  API();
+  s_tap_handler = NULL;
+}
+
+static BatteryStateHandler s_battery_handler;
+static BatteryChargeState s_battery;
+
+void battery_state_service_subscribe(BatteryStateHandler handler) {
+  API();
+  s_battery_handler = handler;
+}
+
+void battery_state_service_unsubscribe(void) {
+  API();
+  s_battery_handler = NULL;
+}
+
+BatteryChargeState battery_state_service_peek(void) {
+  API();
+  return s_battery;
+}
+
+static HealthEventHandler s_health_handler;
+static void *s_health_context;
+static int32_t s_steps_today;
+static int s_steps_day = -1;
+
+bool health_service_events_subscribe(HealthEventHandler handler, void *context) {
+  API();
+  s_health_handler = handler;
+  s_health_context = context;
+  return true;
+}
+
+bool health_service_events_unsubscribe(void) {
+  API();
+  s_health_handler = NULL;
+  return true;
+}
+
+// diorite and emery watches are modelled with a heart rate sensor
+#if defined(PBL_PLATFORM_DIORITE) || defined(PBL_PLATFORM_EMERY)
+#define SIM_HAS_HRM 1
+#else
+#define SIM_HAS_HRM 0
+#endif
+// The system samples every ten minutes unless an app asks for more, for an hour at a time
+#define HRM_DEFAULT_PERIOD_S 600
+#define HRM_PERIOD_LIFETIME_MS (60 * 60 * 1000)
+
+static int64_t s_last_steps_ms = -1;
+static int32_t s_last_steps_burst;
+static uint16_t s_hrm_period_s;
+static int64_t s_hrm_period_expires_ms;
+static int64_t s_next_hrm_ms = SIM_HAS_HRM ? 0 : -1;
+static int32_t s_heart_rate;
+
+HealthServiceAccessibilityMask health_service_metric_accessible(HealthMetric metric, time_t time_start, time_t time_end) {
+  (void) time_start;
+  (void) time_end;
+  API();
+  bool available = metric == HealthMetricStepCount || (SIM_HAS_HRM && metric == HealthMetricHeartRateBPM);
+  return available ? HealthServiceAccessibilityMaskAvailable : HealthServiceAccessibilityMaskNotSupported;
+}
+
+HealthValue health_service_sum_today(HealthMetric metric) {
+  API();
+  s_counters[SIM_COUNTER_HEALTH_READ]++;
+  return metric == HealthMetricStepCount ? s_steps_today : 0;
+}
+
+HealthValue health_service_peek_current_value(HealthMetric metric) {
+  API();
+  s_counters[SIM_COUNTER_HEALTH_READ]++;
+  return metric == HealthMetricHeartRateBPM ? s_heart_rate : 0;
+}
+
+static uint16_t hrm_period_s(void) {
+  return s_hrm_period_s && s_now_ms < s_hrm_period_expires_ms ? s_hrm_period_s : HRM_DEFAULT_PERIOD_S;
+}
+
+bool health_service_set_heart_rate_sample_period(uint16_t interval_sec) {
+  API();
+  if (!SIM_HAS_HRM) return false;
+  s_hrm_period_s = interval_sec;
+  s_hrm_period_expires_ms = s_now_ms + HRM_PERIOD_LIFETIME_MS;
+  int64_t next = s_now_ms + (int64_t)hrm_period_s() * 1000;
+  if (next < s_next_hrm_ms) s_next_hrm_ms = next;
+  return true;
+}
+
+uint32_t health_service_get_heart_rate_sample_period_expiration_sec(void) {
+  API();
+  return s_hrm_period_s && s_now_ms < s_hrm_period_expires_ms ? (uint32_t)((s_hrm_period_expires_ms - s_now_ms) / 1000) : 0;
+}
+
+// Resting pulse, raised for a few minutes after each walking burst
+static void run_hrm_sample(void) {
+  s_counters[SIM_COUNTER_HRM_SAMPLE]++;
+  bool walked = s_last_steps_ms >= 0 && s_now_ms - s_last_steps_ms < 5 * 60 * 1000;
+  s_heart_rate = 62 + (walked ? s_last_steps_burst / 6 : 0) + (int32_t)(s_now_ms / 60000 % 3);
+  s_next_hrm_ms = s_now_ms + (int64_t)hrm_period_s() * 1000;
+  if (s_health_handler) {
+    s_counters[SIM_COUNTER_WAKEUP]++;
+    s_health_handler(HealthEventHeartRateUpdate, s_health_context);
+  }
+}
+
+static AppFocusHandler s_focus_handler;
+
+void app_focus_service_subscribe(AppFocusHandler handler) {
+  API();
+  s_focus_handler = handler;
+}
+
+void app_focus_service_unsubscribe(void) {
+  API();
+  s_focus_handler = NULL;
+}
+
+bool app_worker_is_running(void) {
+  API();
+  return false;
+}
+
+AppWorkerResult app_worker_launch(void) {
+  API();
+  return APP_WORKER_RESULT_NO_WORKER;
+}
+
+AppWorkerResult app_worker_kill(void) {
+  API();
+  return APP_WORKER_RESULT_NOT_RUNNING;
+}
+
+bool app_worker_message_subscribe(AppWorkerMessageHandler handler) {
+  (void) handler;
+  API();
+  return true;
+}
+
+bool app_worker_message_unsubscribe(void) {
+  API();
+  return true;
+}
+
+void app_worker_send_message(uint8_t type, AppWorkerMessage *data) {
+  (void) type;
+  (void) data;
+  API();
+}
+
+static void roll_over_day(void) {
+  time_t now = sim_time(NULL);
+  int yday = localtime(&now)->tm_yday;
+  if (s_steps_day != yday) {
+    s_steps_day = yday;
+    s_steps_today = 0;
+  }
+}
+
+// ============================================================================
+// DICTIONARY & APP MESSAGE
+// ============================================================================
+
+struct DictionaryIterator {
+  uint8_t buffer[DICT_BUFFER_SIZE];
+  uint16_t size;
+};
+
+#define TUPLE_HEADER_SIZE 7
+
+Tuple *dict_find(const DictionaryIterator *iter, const uint32_t key) {
+  API();
+  uint16_t offset = 0;
+  while (offset + TUPLE_HEADER_SIZE <= iter->size) {
+    Tuple *tuple = (Tuple *)&iter->buffer[offset];
+    if (tuple->key == key) return tuple;
+    offset += TUPLE_HEADER_SIZE + tuple->length;
+  }
+  return NULL;
+}
+
+static DictionaryResult write_tuple(DictionaryIterator *iter, uint32_t key, TupleType type,
+                                    const void *data, uint16_t length) {
+  if (!iter || iter->size + TUPLE_HEADER_SIZE + length > DICT_BUFFER_SIZE) return DICT_NOT_ENOUGH_STORAGE;
+  Tuple *tuple = (Tuple *)&iter->buffer[iter->size];
+  tuple->key = key;
+  tuple->type = type;
+  tuple->length = length;
+  memcpy(tuple->value->data, data, length);
+  iter->size += TUPLE_HEADER_SIZE + length;
+  return DICT_OK;
+}
+
+DictionaryResult dict_write_data(DictionaryIterator *iter, const uint32_t key, const uint8_t *data, const uint16_t size) {
+  API();
+  return write_tuple(iter, key, TUPLE_BYTE_ARRAY, data, size);
+}
+
+DictionaryResult dict_write_cstring(DictionaryIterator *iter, const uint32_t key, const char *cstring) {
+  API();
+  return write_tuple(iter, key, TUPLE_CSTRING, cstring, strlen(cstring) + 1);
+}
+
+DictionaryResult dict_write_int(DictionaryIterator *iter, const uint32_t key, const void *integer, const uint8_t width_bytes, const bool is_signed) {
+  API();
+  return write_tuple(iter, key, is_signed ? TUPLE_INT : TUPLE_UINT, integer, width_bytes);
+}
+
+DictionaryResult dict_write_uint8(DictionaryIterator *iter, const uint32_t key, const uint8_t value) {
+  API();
+  return write_tuple(iter, key, TUPLE_UINT, &value, sizeof(value));
+}
+
+DictionaryResult dict_write_uint16(DictionaryIterator *iter, const uint32_t key, const uint16_t value) {
+  API();
+  return write_tuple(iter, key, TUPLE_UINT, &value, sizeof(value));
+}
+
+DictionaryResult dict_write_uint32(DictionaryIterator *iter, const uint32_t key, const uint32_t value) {
+  API();
+  return write_tuple(iter, key, TUPLE_UINT, &value, sizeof(value));
+}
+
+DictionaryResult dict_write_int32(DictionaryIterator *iter, const uint32_t key, const int32_t value) {
+  API();
+  return write_tuple(iter, key, TUPLE_INT, &value, sizeof(value));
+}
+
+uint32_t dict_write_end(DictionaryIterator *iter) {
+  API();
+  return iter ? iter->size : 0;
+}
+
+static AppMessageInboxReceived s_inbox_received;
+static AppMessageOutboxSent s_outbox_sent;
+static AppMessageOutboxFailed s_outbox_failed;
+static uint32_t s_inbox_size, s_outbox_size;
+static DictionaryIterator s_outbox;
+static bool s_outbox_open, s_outbox_in_flight;
+
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound) {
+  API();
+  s_inbox_size = size_inbound;
+  s_outbox_size = size_outbound;
+  return APP_MSG_OK;
+}
+
+AppMessageInboxReceived app_message_register_inbox_received(AppMessageInboxReceived received_callback) {
+  API();
+  AppMessageInboxReceived previous = s_inbox_received;
+  s_inbox_received = received_callback;
+  return previous;
+}
+
+AppMessageInboxDropped app_message_register_inbox_dropped(AppMessageInboxDropped dropped_callback) {
+  (void) dropped_callback;
+  API();
+  return NULL;
+}
+
+AppMessageOutboxSent app_message_register_outbox_sent(AppMessageOutboxSent sent_callback) {
+  API();
+  AppMessageOutboxSent previous = s_outbox_sent;
+  s_outbox_sent = sent_callback;
+  return previous;
+}
+
+AppMessageOutboxFailed app_message_register_outbox_failed(AppMessageOutboxFailed failed_callback) {
+  API();
+  AppMessageOutboxFailed previous = s_outbox_failed;
+  s_outbox_failed = failed_callback;
+  return previous;
+}
+
+AppMessageResult app_message_outbox_begin(DictionaryIterator **iterator) {
+  API();
+  if (s_outbox_in_flight || s_outbox_open) {
+    *iterator = NULL;
+    return APP_MSG_BUSY;
+  }
+  s_outbox.size = 0;
+  s_outbox_open = true;
+  *iterator = &s_outbox;
+  return APP_MSG_OK;
+}
+
+// Work the phone does in response: acks and, optionally, weather replies
+typedef enum { INTERNAL_OUTBOX_ACK, INTERNAL_WEATHER_REPLY } InternalKind;
+
+static struct {
+  int64_t at_ms;
+  InternalKind kind;
+} s_internal[MAX_INTERNAL];
+static int s_internal_count;
+
+static void schedule_internal(InternalKind kind, int64_t at_ms) {
+  if (s_internal_count >= MAX_INTERNAL) return;
+  s_internal[s_internal_count].at_ms = at_ms;
+  s_internal[s_internal_count].kind = kind;
+  s_internal_count++;
+}
+
+AppMessageResult app_message_outbox_send(void) {
+  API();
+  if (!s_outbox_open) return APP_MSG_BUSY;
+  s_outbox_open = false;
+  if (s_outbox.size > s_outbox_size) {
+    if (s_outbox_failed) s_outbox_failed(&s_outbox, APP_MSG_BUFFER_OVERFLOW, NULL);
+    return APP_MSG_BUFFER_OVERFLOW;
+  }
+  s_outbox_in_flight = true;
+  s_counters[SIM_COUNTER_MESSAGE_OUT]++;
+  s_counters[SIM_COUNTER_MESSAGE_BYTES] += s_outbox.size;
+  schedule_internal(INTERNAL_OUTBOX_ACK, s_now_ms + OUTBOX_ACK_MS);
+
+  // Key 1 is the weather request; pkjs answers it with a forecast
+  if (s_config.auto_weather && dict_find(&s_outbox, 1)) {
+    schedule_internal(INTERNAL_WEATHER_REPLY, s_now_ms + s_config.weather_latency_ms);
+  }
+  return APP_MSG_OK;
+}
+
+static void deliver_inbox(DictionaryIterator *iter) {
+  s_counters[SIM_COUNTER_MESSAGE_IN]++;
+  s_counters[SIM_COUNTER_MESSAGE_BYTES] += iter->size;
+  if (iter->size > s_inbox_size) return;  // dropped
+  if (s_inbox_received) {
+    s_counters[SIM_COUNTER_WAKEUP]++;
+    s_inbox_received(iter, NULL);
+  }
+}
+
+// What pkjs's iconFromWeatherId() would pick for the condition
+static int32_t weather_icon(const char *condition) {
+  if (strncmp(condition, "clear", 5) == 0) return 0;
+  if (strncmp(condition, "snow", 4) == 0) return 3;
+  if (strncmp(condition, "rain", 4) == 0 || strncmp(condition, "drizzle", 7) == 0 ||
+      strncmp(condition, "thunderstorm", 12) == 0) return 2;
+  return 1;
+}
+
+static void deliver_weather(int32_t temperature, const char *condition) {
+  DictionaryIterator iter = { .size = 0 };
+  int32_t icon = weather_icon(condition);
+  write_tuple(&iter, 0, TUPLE_INT, &icon, sizeof(icon));
+  write_tuple(&iter, 1, TUPLE_INT, &temperature, sizeof(temperature));
+  write_tuple(&iter, 2, TUPLE_CSTRING, condition, strlen(condition) + 1);
+  deliver_inbox(&iter);
+}
+
+// A plausible day: temperature peaking mid-afternoon, showers in the evening
+static void deliver_synthetic_weather(void) {
+  time_t now = sim_time(NULL);
+  struct tm t = *localtime(&now);
+  double hour = t.tm_hour + t.tm_min / 60.0;
+  int32_t temperature = (int32_t)lround(12 + 6 * sin((hour - 9) * M_PI / 12));
+  const char *condition = (t.tm_hour >= 17 && t.tm_hour < 20) ? "rain now" :
+                          (t.tm_hour >= 14 && t.tm_hour < 17) ? "rain three hr" : "clouds";
+  deliver_weather(temperature, condition);
+}
+
+static void run_internal(int index) {
+  InternalKind kind = s_internal[index].kind;
+  s_internal[index] = s_internal[--s_internal_count];
+  switch (kind) {
+    case INTERNAL_OUTBOX_ACK:
+      s_outbox_in_flight = false;
+      if (s_outbox_sent) {
+        s_counters[SIM_COUNTER_WAKEUP]++;
+        s_outbox_sent(&s_outbox, NULL);
+      }
+      break;
+    case INTERNAL_WEATHER_REPLY:
+      deliver_synthetic_weather();
+      break;
+  }
+}
+
+// ============================================================================
+// PERSISTENT STORAGE
+// ============================================================================
+
+static struct {
+  bool used;
+  uint32_t key;
+  uint16_t size;
+  uint8_t data[PERSIST_DATA_MAX_LENGTH];
+} s_persist[MAX_PERSIST_KEYS];
+
+static int find_persist(uint32_t key) {
+  for (int i = 0; i < MAX_PERSIST_KEYS; i++) {
+    if (s_persist[i].used && s_persist[i].key == key) return i;
+  }
+  return -1;
+}
+
+static int write_persist(uint32_t key, const void *data, size_t size) {
+  if (size > PERSIST_DATA_MAX_LENGTH) size = PERSIST_DATA_MAX_LENGTH;
+  int slot = find_persist(key);
+  for (int i = 0; slot < 0 && i < MAX_PERSIST_KEYS; i++) {
+    if (!s_persist[i].used) slot = i;
+  }
+  if (slot < 0) return -1;
+  s_persist[slot].used = true;
+  s_persist[slot].key = key;
+  s_persist[slot].size = size;
+  memcpy(s_persist[slot].data, data, size);
+  s_counters[SIM_COUNTER_PERSIST_WRITE]++;
+  s_counters[SIM_COUNTER_PERSIST_BYTES] += size;
+  return (int)size;
+}
+
+static int read_persist(uint32_t key, void *buffer, size_t size) {
+  int slot = find_persist(key);
+  if (slot < 0) return -1;
+  size_t n = s_persist[slot].size < size ? s_persist[slot].size : size;
+  memcpy(buffer, s_persist[slot].data, n);
+  return (int)n;
+}
+
+bool persist_exists(const uint32_t key) {
+  API();
+  return find_persist(key) >= 0;
+}
+
+int persist_get_size(const uint32_t key) {
+  API();
+  int slot = find_persist(key);
+  return slot < 0 ? -1 : s_persist[slot].size;
+}
+
+int32_t persist_read_int(const uint32_t key) {
+  API();
+  int32_t value = 0;
+  read_persist(key, &value, sizeof(value));
+  return value;
+}
+
+bool persist_read_bool(const uint32_t key) {
+  API();
+  bool value = false;
+  read_persist(key, &value, sizeof(value));
+  return value;
+}
+
+int persist_read_data(const uint32_t key, void *buffer, const size_t buffer_size) {
+  API();
+  return read_persist(key, buffer, buffer_size);
+}
+
+int persist_read_string(const uint32_t key, char *buffer, const size_t buffer_size) {
+  API();
+  int n = read_persist(key, buffer, buffer_size);
+  if (n > 0) buffer[buffer_size - 1] = '\0';
+  return n;
+}
+
+int persist_write_int(const uint32_t key, const int32_t value) {
+  API();
+  return write_persist(key, &value, sizeof(value));
+}
+
+int persist_write_bool(const uint32_t key, const bool value) {
+  API();
+  return write_persist(key, &value, sizeof(value));
+}
+
+int persist_write_data(const uint32_t key, const void *data, const size_t size) {
+  API();
+  return write_persist(key, data, size);
+}
+
+int persist_write_string(const uint32_t key, const char *cstring) {
+  API();
+  return write_persist(key, cstring, strlen(cstring) + 1);
+}
+
+int persist_delete(const uint32_t key) {
+  API();
+  int slot = find_persist(key);
+  if (slot >= 0) s_persist[slot].used = false;
+  return 0;
+}
+
+// ============================================================================
+// EVENT LOOP
+// ============================================================================
+
+static void run_script_event(const SimEvent *event) {
+  switch (event->type) {
+    case SIM_EVENT_STEPS:
+      s_steps_today += event->value;
+      s_last_steps_ms = s_now_ms;
+      s_last_steps_burst = event->value;
+      if (s_health_handler) {
+        s_counters[SIM_COUNTER_WAKEUP]++;
+        s_health_handler(HealthEventMovementUpdate, s_health_context);
+      }
+      break;
+    case SIM_EVENT_BATTERY:
+      s_battery.charge_percent = (uint8_t)event->value;
+      s_battery.is_charging = event->flag;
+      s_battery.is_plugged = event->flag;
+      if (s_battery_handler) {
+        s_counters[SIM_COUNTER_WAKEUP]++;
+        s_battery_handler(s_battery);
+      }
+      break;
+    case SIM_EVENT_WEATHER:
+      deliver_weather(event->value, event->text);
+      break;
+    case SIM_EVENT_MESSAGE: {
+      DictionaryIterator iter = { .size = 0 };
+      for (int i = 0; i < event->pair_count; i++) {
+        write_tuple(&iter, (uint32_t)event->keys[i], TUPLE_INT, &event->values[i], sizeof(int32_t));
+      }
+      deliver_inbox(&iter);
+      break;
+    }
+    case SIM_EVENT_TAP:
+      if (s_tap_handler) {
+        s_counters[SIM_COUNTER_WAKEUP]++;
+        s_tap_handler(ACCEL_AXIS_Y, 1);
+      }
+      break;
+  }
+}
+
+static void run_tick(void) {
+  time_t now = sim_time(NULL);
+  struct tm t = *localtime(&now);
+  TimeUnits changed = SECOND_UNIT;
+  if (t.tm_sec == 0) changed |= MINUTE_UNIT;
+  if (t.tm_sec == 0 && t.tm_min == 0) changed |= HOUR_UNIT;
+  if (t.tm_sec == 0 && t.tm_min == 0 && t.tm_hour == 0) changed |= DAY_UNIT;
+  TickHandler handler = s_tick_handler;
+  schedule_next_tick();
+  if (handler && (changed & s_tick_units)) {
+    s_counters[SIM_COUNTER_TICK]++;
+    s_counters[SIM_COUNTER_WAKEUP]++;
+    handler(&t, changed);
+  }
+}
+
+static void consider(int64_t *next, int64_t candidate) {
+  if (candidate >= 0 && candidate < *next) *next = candidate;
+}
+
+void app_event_loop(void) {
+  API();
+  s_battery.charge_percent = s_config.initial_battery;
+  roll_over_day();
+  schedule_next_tick();
+
+  if (s_top_window && s_top_window->handlers.appear) {
+    s_counters[SIM_COUNTER_WAKEUP]++;
+    s_top_window->handlers.appear(s_top_window);
+  }
+
+  int next_event = 0;
+  while (true) {
+    if (s_dirty) {
+      s_counters[SIM_COUNTER_DISPLAY_REFRESH]++;
+      s_dirty = false;
+    }
+
+    int64_t next = INT64_MAX;
+    if (next_event < s_config.event_count) consider(&next, s_config.events[next_event].at_ms);
+    consider(&next, s_next_tick_ms);
+    consider(&next, s_next_frame_ms);
+    consider(&next, s_next_hrm_ms);
+    AppTimer *timer = next_timer();
+    if (timer) consider(&next, timer->fire_ms);
+    int internal = -1;
+    for (int i = 0; i < s_internal_count; i++) {
+      if (internal < 0 || s_internal[i].at_ms < s_internal[internal].at_ms) internal = i;
+    }
+    if (internal >= 0) consider(&next, s_internal[internal].at_ms);
+
+    if (next == INT64_MAX || next > s_config.duration_ms) break;
+    if (next > s_now_ms) s_now_ms = next;
+    roll_over_day();
+
+    if (next_event < s_config.event_count && s_config.events[next_event].at_ms == next) {
+      run_script_event(&s_config.events[next_event++]);
+    } else if (internal >= 0 && s_internal[internal].at_ms == next) {
+      run_internal(internal);
+    } else if (timer && timer->fire_ms == next) {
+      remove_timer(timer);
+      s_counters[SIM_COUNTER_TIMER_FIRE]++;
+      s_counters[SIM_COUNTER_WAKEUP]++;
+      timer->callback(timer->data);
+      free(timer);
+    } else if (s_next_tick_ms == next) {
+      run_tick();
+    } else if (s_next_frame_ms == next) {
+      run_animation_frame();
+    } else if (s_next_hrm_ms == next) {
+      run_hrm_sample();
+    }
+  }
+
+  s_now_ms = s_config.duration_ms;
+}
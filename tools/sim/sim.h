@@ -0,0 +1,67 @@
+// Interface between the mocked Pebble API (pebble_mock.c) and the
+// simulator driver (sim_main.c).
+#pragma once
+
+#include "pebble.h"
+
+typedef enum {
+  SIM_EVENT_STEPS,      // value: steps walked
+  SIM_EVENT_BATTERY,    // value: percent, flag: charging
+  SIM_EVENT_WEATHER,    // value: temperature, text: condition
+  SIM_EVENT_MESSAGE,    // keys/values: integer AppMessage to the watch
+  SIM_EVENT_TAP,        // wrist flick
+} SimEventType;
+
+#define SIM_MESSAGE_MAX_PAIRS 4
+
+typedef struct {
+  int64_t at_ms;        // offset from the start of the simulation
+  SimEventType type;
+  int32_t value;
+  int32_t keys[SIM_MESSAGE_MAX_PAIRS], values[SIM_MESSAGE_MAX_PAIRS];
+  uint8_t pair_count;
+  bool flag;
+  char text[32];
+} SimEvent;
+
+// Everything the cost model can put a price on
+typedef enum {
+  SIM_COUNTER_WAKEUP,          // app code entered from the event loop
+  SIM_COUNTER_TICK,
+  SIM_COUNTER_TIMER_FIRE,
+  SIM_COUNTER_ANIMATION_FRAME,
+  SIM_COUNTER_DISPLAY_REFRESH, // event loop passes that left something dirty
+  SIM_COUNTER_TEXT_LAYOUT,     // graphics_text_layout_get_content_size
+  SIM_COUNTER_TEXT_SET,        // text_layer_set_text (relayout + redraw)
+  SIM_COUNTER_LAYER_MOVE,
+  SIM_COUNTER_PERSIST_WRITE,
+  SIM_COUNTER_PERSIST_BYTES,
+  SIM_COUNTER_MESSAGE_OUT,
+  SIM_COUNTER_MESSAGE_IN,
+  SIM_COUNTER_MESSAGE_BYTES,
+  SIM_COUNTER_HEALTH_READ,
+  SIM_COUNTER_HRM_SAMPLE,      // heart rate sensor lit for a reading
+  SIM_COUNTER_COUNT
+} SimCounter;
+
+typedef struct {
+  time_t start;             // wall clock at the start of the simulation
+  int64_t duration_ms;
+  const SimEvent *events;   // sorted by at_ms
+  int event_count;
+  bool auto_weather;        // answer each weather request like pkjs would
+  uint32_t weather_latency_ms;
+  uint8_t initial_battery;
+  bool verbose;
+} SimConfig;
+
+void sim_configure(const SimConfig *config);
+
+int64_t sim_now_ms(void);
+uint64_t sim_counter(SimCounter counter);
+const char *sim_counter_name(SimCounter counter);
+
+// Per-function call counts for every mocked API entry point
+int sim_api_count(void);
+const char *sim_api_name(int index);
+uint64_t sim_api_calls(int index);
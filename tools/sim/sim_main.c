@@ -0,0 +1,288 @@
+// Host-side energy simulator for the watchface.
+//
+// Replays a recorded (or synthetic) event log through the real watchface
+// sources linked against pebble_mock.c, then weights the counted work with
+// a cost model to estimate charge drawn per day.
+//
+//   sim [-l events.log] [-c cost_model.cfg] [-s YYYY-MM-DDTHH:MM] [-d hours] [-v]
+#include "sim.h"
+
+#include <unistd.h>
+
+#define MAX_EVENTS 8192
+
+int watchface_main(void);
+
+static SimEvent s_events[MAX_EVENTS];
+static int s_event_count;
+
+// ============================================================================
+// EVENT LOG
+// ============================================================================
+
+static void add_event(SimEvent event) {
+  if (s_event_count < MAX_EVENTS) s_events[s_event_count++] = event;
+}
+
+static int compare_events(const void *a, const void *b) {
+  int64_t lhs = ((const SimEvent *)a)->at_ms, rhs = ((const SimEvent *)b)->at_ms;
+  return (lhs > rhs) - (lhs < rhs);
+}
+
+// One event per line, time as seconds from the start of the run:
+//   <seconds> steps <count>
+//   <seconds> battery <percent> [charging]
+//   <seconds> weather <celsius> <condition words...>
+//   <seconds> message <key> <value> [<key> <value>...]
+//   <seconds> tap
+static bool load_event_log(const char *path) {
+  FILE *file = fopen(path, "r");
+  if (!file) {
+    perror(path);
+    return false;
+  }
+
+  char line[128];
+  int line_number = 0;
+  while (fgets(line, sizeof(line), file)) {
+    line_number++;
+    char *hash = strchr(line, '#');
+    if (hash) *hash = '\0';
+
+    double seconds;
+    char type[16];
+    int consumed;
+    if (sscanf(line, "%lf %15s %n", &seconds, type, &consumed) < 2) continue;
+
+    SimEvent event = { .at_ms = (int64_t)(seconds * 1000) };
+    const char *args = line + consumed;
+    bool ok = true;
+    if (strcmp(type, "steps") == 0) {
+      event.type = SIM_EVENT_STEPS;
+      ok = sscanf(args, "%d", &event.value) == 1;
+    } else if (strcmp(type, "battery") == 0) {
+      char flag[16] = "";
+      event.type = SIM_EVENT_BATTERY;
+      ok = sscanf(args, "%d %15s", &event.value, flag) >= 1;
+      event.flag = strcmp(flag, "charging") == 0;
+    } else if (strcmp(type, "weather") == 0) {
+      int used = 0;
+      event.type = SIM_EVENT_WEATHER;
+      ok = sscanf(args, "%d %n", &event.value, &used) == 1;
+      strncpy(event.text, args + used, sizeof(event.text) - 1);
+      event.text[strcspn(event.text, "\r\n")] = '\0';
+    } else if (strcmp(type, "message") == 0) {
+      int used = 0;
+      event.type = SIM_EVENT_MESSAGE;
+      while (event.pair_count < SIM_MESSAGE_MAX_PAIRS &&
+             sscanf(args, "%d %d %n", &event.keys[event.pair_count], &event.values[event.pair_count], &used) == 2) {
+        event.pair_count++;
+        args += used;
+      }
+      ok = event.pair_count > 0;
+    } else if (strcmp(type, "tap") == 0) {
+      event.type = SIM_EVENT_TAP;
+    } else {
+      ok = false;
+    }
+
+    if (!ok) {
+      fprintf(stderr, "%s:%d: cannot parse event\n", path, line_number);
+      fclose(file);
+      return false;
+    }
+    add_event(event);
+  }
+  fclose(file);
+  return true;
+}
+
+// A typical day: walking bursts around the commute and lunch, steady
+// battery drain, and a charge in the evening
+static void generate_synthetic_log(int64_t duration_ms) {
+  srand(1);
+  int battery = 90;
+  for (int64_t t = 0; t < duration_ms; t += 5 * 60 * 1000) {
+    int hour = (int)((t / (60 * 60 * 1000)) % 24);
+    bool walking = hour == 8 || hour == 12 || hour == 17 || (hour >= 9 && hour < 20 && rand() % 4 == 0);
+    if (walking) {
+      add_event((SimEvent) { .at_ms = t, .type = SIM_EVENT_STEPS, .value = 300 + rand() % 300 });
+    }
+    if (t % (40 * 60 * 1000) == 0 && t > 0) {
+      bool charging = hour >= 22;
+      battery = charging ? (battery + 30 > 100 ? 100 : battery + 30) : battery - 1;
+      add_event((SimEvent) { .at_ms = t + 1, .type = SIM_EVENT_BATTERY, .value = battery, .flag = charging });
+    }
+  }
+}
+
+// ============================================================================
+// COST MODEL
+// ============================================================================
+
+// Charge per counted event in microamp-hours, plus the idle floor
+static double s_counter_cost[SIM_COUNTER_COUNT] = {
+  [SIM_COUNTER_WAKEUP] = 0.02,
+  [SIM_COUNTER_TICK] = 0.0,
+  [SIM_COUNTER_TIMER_FIRE] = 0.0,
+  [SIM_COUNTER_ANIMATION_FRAME] = 0.01,
+  [SIM_COUNTER_DISPLAY_REFRESH] = 0.05,
+  [SIM_COUNTER_TEXT_LAYOUT] = 0.002,
+  [SIM_COUNTER_TEXT_SET] = 0.004,
+  [SIM_COUNTER_LAYER_MOVE] = 0.001,
+  [SIM_COUNTER_PERSIST_WRITE] = 0.3,
+  [SIM_COUNTER_PERSIST_BYTES] = 0.001,
+  [SIM_COUNTER_MESSAGE_OUT] = 1.5,
+  [SIM_COUNTER_MESSAGE_IN] = 1.0,
+  [SIM_COUNTER_MESSAGE_BYTES] = 0.005,
+  [SIM_COUNTER_HEALTH_READ] = 0.01,
+  [SIM_COUNTER_HRM_SAMPLE] = 0.5,
+};
+static double s_idle_uah_per_hour = 200.0;
+
+// "name = value" lines; names are counter names or idle_uah_per_hour
+static bool load_cost_model(const char *path) {
+  FILE *file = fopen(path, "r");
+  if (!file) {
+    perror(path);
+    return false;
+  }
+
+  char line[128];
+  int line_number = 0;
+  while (fgets(line, sizeof(line), file)) {
+    line_number++;
+    char *hash = strchr(line, '#');
+    if (hash) *hash = '\0';
+
+    char name[48];
+    double value;
+    if (sscanf(line, " %47[a-z_] = %lf", name, &value) != 2) continue;
+
+    bool known = false;
+    if (strcmp(name, "idle_uah_per_hour") == 0) {
+      s_idle_uah_per_hour = value;
+      known = true;
+    }
+    for (int i = 0; i < SIM_COUNTER_COUNT && !known; i++) {
+      if (strcmp(name, sim_counter_name(i)) == 0) {
+        s_counter_cost[i] = value;
+        known = true;
+      }
+    }
+    if (!known) fprintf(stderr, "%s:%d: unknown cost '%s'\n", path, line_number, name);
+  }
+  fclose(file);
+  return true;
+}
+
+// ============================================================================
+// REPORT
+// ============================================================================
+
+static int compare_api(const void *a, const void *b) {
+  uint64_t lhs = sim_api_calls(*(const int *)a), rhs = sim_api_calls(*(const int *)b);
+  return (lhs < rhs) - (lhs > rhs);
+}
+
+static void print_report(int64_t duration_ms) {
+  double days = duration_ms / (24.0 * 60 * 60 * 1000);
+  double hours = duration_ms / (60.0 * 60 * 1000);
+
+  printf("Simulated %.1f h, %d scripted events\n\n", hours, s_event_count);
+  printf("%-18s %12s %12s %12s\n", "counter", "count", "per day", "uAh/day");
+  double active = 0;
+  for (int i = 0; i < SIM_COUNTER_COUNT; i++) {
+    double per_day = sim_counter(i) / days;
+    double charge = per_day * s_counter_cost[i];
+    active += charge;
+    printf("%-18s %12llu %12.0f %12.1f\n", sim_counter_name(i),
+           (unsigned long long)sim_counter(i), per_day, charge);
+  }
+
+  double idle = s_idle_uah_per_hour * 24;
+  printf("\nidle floor        %10.1f uAh/day\n", idle);
+  printf("watchface work    %10.1f uAh/day\n", active);
+  printf("total             %10.1f uAh/day (%.2f mAh)\n", idle + active, (idle + active) / 1000);
+
+  int order[256];
+  int count = sim_api_count() < 256 ? sim_api_count() : 256;
+  for (int i = 0; i < count; i++) order[i] = i;
+  qsort(order, count, sizeof(int), compare_api);
+  printf("\n%-44s %12s\n", "API call", "per day");
+  for (int i = 0; i < count; i++) {
+    printf("%-44s %12.0f\n", sim_api_name(order[i]), sim_api_calls(order[i]) / days);
+  }
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+          "usage: %s [-l events.log] [-c cost_model.cfg] [-s YYYY-MM-DDTHH:MM] [-d hours]\n"
+          "          [-w weather_latency_ms] [-b initial_battery] [-n] [-v]\n"
+          "  -l  replay an event log instead of the synthetic day\n"
+          "  -n  do not answer weather requests automatically\n",
+          argv0);
+}
+
+int main(int argc, char **argv) {
+  const char *log_path = NULL, *cost_path = NULL;
+  SimConfig config = {
+    .duration_ms = 24LL * 60 * 60 * 1000,
+    .auto_weather = true,
+    .weather_latency_ms = 2500,
+    .initial_battery = 90,
+  };
+
+  // Everything runs in UTC so recorded logs replay identically anywhere
+  setenv("TZ", "UTC", 1);
+  tzset();
+  struct tm start = { .tm_year = 2024 - 1900, .tm_mon = 5, .tm_mday = 1, .tm_hour = 0 };
+
+  int opt;
+  while ((opt = getopt(argc, argv, "l:c:s:d:w:b:nvh")) != -1) {
+    switch (opt) {
+      case 'l': log_path = optarg; break;
+      case 'c': cost_path = optarg; break;
+      case 's':
+        memset(&start, 0, sizeof(start));
+        if (sscanf(optarg, "%d-%d-%dT%d:%d", &start.tm_year, &start.tm_mon, &start.tm_mday,
+                   &start.tm_hour, &start.tm_min) != 5) {
+          usage(argv[0]);
+          return 2;
+        }
+        start.tm_year -= 1900;
+        start.tm_mon -= 1;
+        break;
+      case 'd': config.duration_ms = (int64_t)(atof(optarg) * 60 * 60 * 1000); break;
+      case 'w': config.weather_latency_ms = (uint32_t)atoi(optarg); break;
+      case 'b': config.initial_battery = (uint8_t)atoi(optarg); break;
+      case 'n': config.auto_weather = false; break;
+      case 'v': config.verbose = true; break;
+      default:
+        usage(argv[0]);
+        return opt == 'h' ? 0 : 2;
+    }
+  }
+
+  if (cost_path && !load_cost_model(cost_path)) return 1;
+  if (log_path) {
+    if (!load_event_log(log_path)) return 1;
+  } else {
+    generate_synthetic_log(config.duration_ms);
+  }
+  qsort(s_events, s_event_count, sizeof(SimEvent), compare_events);
+
+  config.start = mktime(&start);
+  config.events = s_events;
+  config.event_count = s_event_count;
+  sim_configure(&config);
+
+  watchface_main();
+
+  print_report(config.duration_ms);
+  return 0;
+}
@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+"""
+Convert a watch event trace dump into Chrome trace_event JSON.
+
+Enable "Send event trace to phone on save" on the config page, then feed the
+app logs (e.g. `pebble logs > trace.log`) to this script:
+
+    python3 tools/trace_to_chrome.py trace.log > trace.json
+
+Open the result in chrome://tracing or https://ui.perfetto.dev.
+"""
+import argparse
+import json
+import struct
+import sys
+
+# Must match TraceEvent / TraceEventType in src/c/trace.h
+RECORD = struct.Struct('<IBBH')
+
+EVENT_NAMES = {
+    1: 'tick',
+    2: 'health',
+    3: 'battery',
+    4: 'inbox',
+    5: 'slide_in_text',
+    6: 'frame_begin',
+    7: 'frame_end',
+    8: 'persist_write',
+    9: 'filtered',
+    10: 'precompute',
+}
+
+# SlidingTextData row order, as recorded by slide_in_text
+ROW_NAMES = ['hour', 'first_minute', 'second_minute', 'weather', 'condition',
+             'steps', 'battery', 'day', 'date', 'sun', 'heart_rate']
+
+HEALTH_EVENTS = ['significant', 'movement', 'sleep', 'metric_alert', 'heart_rate']
+
+# Hacker frames are scheduled every 70 ms; anything much later is an overrun
+FRAME_INTERVAL_MS = 70
+OVERRUN_FACTOR = 1.5
+
+
+def find_dump(lines):
+    dump = None
+    for line in lines:
+        marker = line.find('TRACE_DUMP ')
+        if marker >= 0:
+            dump = line[marker + len('TRACE_DUMP '):].strip()
+    return dump
+
+
+def decode(hex_dump):
+    data = bytes.fromhex(hex_dump)
+    usable = len(data) - len(data) % RECORD.size
+    return [RECORD.unpack_from(data, offset) for offset in range(0, usable, RECORD.size)]
+
+
+def describe(event_type, arg):
+    if event_type == 2:
+        return {'event': HEALTH_EVENTS[arg] if arg < len(HEALTH_EVENTS) else arg}
+    if event_type == 5:
+        return {'row': ROW_NAMES[arg] if arg < len(ROW_NAMES) else arg}
+    if event_type in (1, 10):
+        return {'minute': arg}
+    if event_type == 3:
+        return {'percent': arg}
+    if event_type == 8:
+        return {'key': arg}
+    if event_type == 9:
+        # Complications follow the three time rows
+        return {'complication': ROW_NAMES[3 + arg] if 3 + arg < len(ROW_NAMES) else arg}
+    return {'arg': arg}
+
+
+def to_chrome(records):
+    events = []
+    if not records:
+        return {'traceEvents': events}
+
+    base = records[0][0]
+    last_frame_begin = None
+    for timestamp, event_type, _, arg in records:
+        # Timestamps are 32-bit milliseconds and may wrap once per ~49 days
+        ts_us = ((timestamp - base) & 0xffffffff) * 1000
+        name = EVENT_NAMES.get(event_type, 'event_%d' % event_type)
+
+        if event_type == 6:
+            events.append({'name': 'hacker frame', 'cat': 'animation', 'ph': 'B',
+                           'ts': ts_us, 'pid': 1, 'tid': 1, 'args': {'frame': arg}})
+            if last_frame_begin is not None and arg > 0:
+                gap_ms = (ts_us - last_frame_begin) / 1000
+                if gap_ms > FRAME_INTERVAL_MS * OVERRUN_FACTOR:
+                    events.append({'name': 'frame overrun', 'cat': 'animation', 'ph': 'i',
+                                   's': 't', 'ts': ts_us, 'pid': 1, 'tid': 1,
+                                   'args': {'gap_ms': gap_ms}})
+            last_frame_begin = ts_us
+        elif event_type == 7:
+            events.append({'name': 'hacker frame', 'cat': 'animation', 'ph': 'E',
+                           'ts': ts_us, 'pid': 1, 'tid': 1})
+        else:
+            events.append({'name': name, 'cat': 'event', 'ph': 'i', 's': 't',
+                           'ts': ts_us, 'pid': 1, 'tid': 2, 'args': describe(event_type, arg)})
+
+    events.append({'name': 'thread_name', 'ph': 'M', 'pid': 1, 'tid': 1, 'args': {'name': 'animation'}})
+    events.append({'name': 'thread_name', 'ph': 'M', 'pid': 1, 'tid': 2, 'args': {'name': 'events'}})
+    return {'traceEvents': events, 'displayTimeUnit': 'ms'}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('log', nargs='?', help='app log containing a TRACE_DUMP line (default: stdin)')
+    args = parser.parse_args()
+
+    if args.log:
+        with open(args.log) as f:
+            lines = f.readlines()
+    else:
+        lines = sys.stdin.readlines()
+
+    dump = find_dump(lines)
+    if dump is None:
+        sys.exit('No TRACE_DUMP line found')
+
+    json.dump(to_chrome(decode(dump)), sys.stdout, indent=1)
+    sys.stdout.write('\n')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+"""Write the weather condition icons as Pebble Draw Command images (.pdc).
+
+The icons are a handful of strokes each, so they are described here rather
+than drawn in an editor and run through svg2pdc. Run from the repository root
+after changing one:
+
+    python3 tools/weather_icons.py
+
+Order matches iconFromWeatherId() in src/pkjs/index.js and the resource list
+in src/c/sliding_text_pp.c: 0 clear, 1 clouds, 2 rain, 3 snow.
+"""
+import os
+import struct
+
+SIZE = 18
+
+# GColor8 is 2 bits each of alpha, red, green and blue
+WHITE = 0xff
+CLEAR = 0x00
+
+PATH = 1
+CIRCLE = 2
+
+
+def path(points, open_path=True, fill=CLEAR, width=2):
+    return (PATH, WHITE, width, fill, 1 if open_path else 0, points)
+
+
+def circle(center, radius, fill=WHITE):
+    return (CIRCLE, WHITE, 1, fill, radius, [center])
+
+
+def cloud(dy):
+    outline = [(3, 14), (15, 14), (17, 12), (16, 9), (13, 8), (11, 5), (7, 5), (5, 8), (2, 9), (1, 12)]
+    return path([(x, y + dy) for x, y in outline], open_path=False)
+
+
+ICONS = {
+    'weather_clear': [circle((9, 9), 4)] + [
+        path([a, b]) for a, b in [((9, 1), (9, 3)), ((9, 15), (9, 17)), ((1, 9), (3, 9)), ((15, 9), (17, 9)),
+                                  ((3, 3), (4, 4)), ((14, 14), (15, 15)), ((3, 15), (4, 14)), ((14, 4), (15, 3))]
+    ],
+    'weather_clouds': [cloud(0)],
+    'weather_rain': [cloud(-4)] + [path([(x, 13), (x - 1, 16)]) for x in (5, 9, 13)],
+    'weather_snow': [cloud(-4)] + [circle(center, 1) for center in ((5, 14), (9, 16), (13, 14))],
+}
+
+
+# See "Pebble Draw Command File Format" in the SDK documentation; little endian
+def encode_command(command):
+    kind, stroke, width, fill, path_or_radius, points = command
+    data = struct.pack('<BBBBBHH', kind, 0, stroke, width, fill, path_or_radius, len(points))
+    for x, y in points:
+        data += struct.pack('<hh', x, y)
+    return data
+
+
+def encode_image(commands):
+    image = struct.pack('<BBhhH', 1, 0, SIZE, SIZE, len(commands))
+    image += b''.join(encode_command(command) for command in commands)
+    return b'PDCI' + struct.pack('<I', len(image)) + image
+
+
+def main():
+    out_dir = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'resources', 'images')
+    os.makedirs(out_dir, exist_ok=True)
+    for name, commands in sorted(ICONS.items()):
+        with open(os.path.join(out_dir, name + '.pdc'), 'wb') as f:
+            f.write(encode_image(commands))
+
+
+if __name__ == '__main__':
+    main()
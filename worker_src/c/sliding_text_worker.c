@@ -0,0 +1,84 @@
+#include <pebble_worker.h>
+#include "../../src/c/feature_profile.h"
+#include "../../src/c/worker_shared.h"
+
+// Persist is flash, so the step total is only written when it has moved
+// noticeably or gone stale; the foreground gets every update by message
+#define STEPS_PERSIST_DELTA 100
+#define STEPS_PERSIST_INTERVAL_S (10 * 60)
+
+static WorkerSnapshot s_snapshot;
+static int32_t s_persisted_steps;
+static time_t s_persisted_time;
+
+static void save_snapshot(void) {
+  persist_write_data(WORKER_PERSIST_SNAPSHOT, &s_snapshot, sizeof(s_snapshot));
+  s_persisted_steps = s_snapshot.steps;
+  s_persisted_time = time(NULL);
+}
+
+#if FEATURE_HEALTH
+static void send_steps(void) {
+  AppWorkerMessage message = {
+    .data0 = (uint16_t)(s_snapshot.steps & 0xffff),
+    .data1 = (uint16_t)((uint32_t)s_snapshot.steps >> 16),
+  };
+  app_worker_send_message(WORKER_MESSAGE_STEPS, &message);
+}
+
+static void update_steps(void) {
+  time_t start = time_start_of_today();
+  time_t now = time(NULL);
+  if (!(health_service_metric_accessible(HealthMetricStepCount, start, now) & HealthServiceAccessibilityMaskAvailable)) return;
+
+  int32_t steps = (int32_t)health_service_sum_today(HealthMetricStepCount);
+  bool new_day = s_snapshot.steps_day != (uint32_t)start;
+  if (steps == s_snapshot.steps && !new_day) return;
+
+  s_snapshot.steps = steps;
+  s_snapshot.steps_day = (uint32_t)start;
+  send_steps();
+
+  if (new_day || abs(steps - s_persisted_steps) >= STEPS_PERSIST_DELTA ||
+      now - s_persisted_time >= STEPS_PERSIST_INTERVAL_S) {
+    save_snapshot();
+  }
+}
+
+static void health_handler(HealthEventType event, void *context) {
+  (void) context;
+  if (event == HealthEventMovementUpdate || event == HealthEventSignificantUpdate) {
+    update_steps();
+  }
+}
+#endif
+
+static void worker_init(void) {
+  if (persist_read_data(WORKER_PERSIST_SNAPSHOT, &s_snapshot, sizeof(s_snapshot)) != sizeof(s_snapshot) ||
+      s_snapshot.version != WORKER_SNAPSHOT_VERSION) {
+    memset(&s_snapshot, 0, sizeof(s_snapshot));
+    s_snapshot.version = WORKER_SNAPSHOT_VERSION;
+  }
+  s_persisted_steps = s_snapshot.steps;
+  s_persisted_time = time(NULL);
+
+#if FEATURE_HEALTH
+  health_service_events_subscribe(health_handler, NULL);
+  update_steps();
+  // A watchface that just launched us is waiting for the first total
+  send_steps();
+#endif
+}
+
+static void worker_deinit(void) {
+#if FEATURE_HEALTH
+  health_service_events_unsubscribe();
+#endif
+  save_snapshot();
+}
+
+int main(void) {
+  worker_init();
+  worker_event_loop();
+  worker_deinit();
+}